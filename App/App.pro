@@ -133,6 +133,7 @@ CONFIG(debug, debug | release) {
 }
 
 SOURCES += \
+    gallery_compositor.cpp \
     gallery_view.cpp \
     main.cpp \
     mainwindow.cpp \
@@ -144,6 +145,7 @@ SOURCES += \
     video_renderer.cpp
 
 HEADERS += \
+    gallery_compositor.h \
     gallery_view.h \
     mainwindow.h \
     participant_event_handler_wrapper.h \
@@ -151,6 +153,7 @@ HEADERS += \
     participant_list_view.h \
     room_client_event_handler_wrapper.h \
     table.h \
+    video_frame_mailbox.h \
     video_renderer.h
 
 FORMS += \
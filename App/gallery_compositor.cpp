@@ -0,0 +1,406 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#include "gallery_compositor.h"
+#include <algorithm>
+#include <cstddef>
+#include <QOpenGLContext>
+#include "logger/spd_logger.h"
+#include "api/video/i420_buffer.h"
+
+namespace {
+    // Quad corners come from gl_VertexID, everything else is per instance:
+    // a_rect is the tile rectangle in NDC, a_tex holds the texture coordinate scale of the layer,
+    // the layer index and the number of quarter turns.
+    const char kCompositorVertexShaderSource[] =
+        "#version 330 core\n"
+        "layout(location = 0) in vec4 a_rect;\n"
+        "layout(location = 1) in vec4 a_tex;\n"
+        "out vec3 v_texcoord;\n"
+        "void main() {\n"
+        "    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n"
+        "    gl_Position = vec4(a_rect.xy + corner * a_rect.zw, 0.0, 1.0);\n"
+        "    vec2 uv = vec2(corner.x, 1.0 - corner.y);\n"
+        "    int turns = int(a_tex.w);\n"
+        "    for (int i = 0; i < turns; ++i) {\n"
+        "        uv = vec2(uv.y, 1.0 - uv.x);\n"
+        "    }\n"
+        "    v_texcoord = vec3(uv * a_tex.xy, a_tex.z);\n"
+        "}\n";
+
+    const char kCompositorFragmentShaderSource[] =
+        "#version 330 core\n"
+        "in vec3 v_texcoord;\n"
+        "uniform sampler2DArray s_textureY;\n"
+        "uniform sampler2DArray s_textureU;\n"
+        "uniform sampler2DArray s_textureV;\n"
+        "out vec4 fragColor;\n"
+        "void main() {\n"
+        "    float y = texture(s_textureY, v_texcoord).r;\n"
+        "    float u = texture(s_textureU, v_texcoord).r - 0.5;\n"
+        "    float v = texture(s_textureV, v_texcoord).r - 0.5;\n"
+        "    fragColor = vec4(y + 1.403 * v, y - 0.344 * u - 0.714 * v, y + 1.770 * u, 1.0);\n"
+        "}\n";
+
+    // Texture arrays only grow, by these steps, so small resolution changes do not reallocate
+    const int kTextureSizeAlignment = 64;
+
+    const int kTextureLayerAlignment = 4;
+
+    int alignUp(int value, int alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    struct TileInstance {
+        GLfloat rect[4];
+        GLfloat tex[4];
+    };
+}
+
+CompositorTile::CompositorTile(GalleryCompositor* compositor, int32_t index)
+    : _compositor(compositor)
+    , _index(index)
+{
+
+}
+
+void CompositorTile::clear()
+{
+    _locked.store(true, std::memory_order_release);
+    _mailbox.take();
+    _frame = nullptr;
+    _frameSize = QSize();
+    _compositor->scheduleUpdate();
+}
+
+void CompositorTile::reset()
+{
+    // A frame posted while clear() ran may still sit in the mailbox
+    if (_locked.exchange(false, std::memory_order_acq_rel)) {
+        _mailbox.take();
+    }
+    _frameSize = QSize();
+}
+
+void CompositorTile::setGeometry(const QRect& rect, bool visible)
+{
+    if (_rect == rect && _visible == visible) {
+        return;
+    }
+    _rect = rect;
+    _visible = visible;
+    _compositor->scheduleUpdate();
+}
+
+void CompositorTile::setRotation(uint8_t rotation)
+{
+    _rotation = static_cast<webrtc::VideoRotation>((rotation % 4) * 90);
+    _compositor->scheduleUpdate();
+}
+
+void CompositorTile::OnFrame(const webrtc::VideoFrame& frame)
+{
+    if (_locked.load(std::memory_order_acquire)) {
+        return;
+    }
+    _mailbox.post(frame);
+    _compositor->scheduleUpdate();
+}
+
+GalleryCompositor::GalleryCompositor(QWidget* parent, int32_t tileCount)
+    : QOpenGLWidget(parent)
+{
+    for (int32_t i = 0; i < tileCount; ++i) {
+        _tiles.emplace_back(std::make_unique<CompositorTile>(this, i));
+    }
+    // Cells and their overlays stay on top and receive the mouse
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+GalleryCompositor::~GalleryCompositor()
+{
+    cleanup();
+}
+
+CompositorTile* GalleryCompositor::tile(int32_t index)
+{
+    if (index < 0 || index >= (int32_t)_tiles.size()) {
+        return nullptr;
+    }
+    return _tiles[index].get();
+}
+
+void GalleryCompositor::scheduleUpdate()
+{
+    // Frames of all tiles arriving before the next paint share one repaint
+    if (_updatePending.exchange(true)) {
+        return;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        _updatePending = false;
+        update();
+    }, Qt::QueuedConnection);
+}
+
+void GalleryCompositor::initializeGL()
+{
+    connect(context(), &QOpenGLContext::aboutToBeDestroyed, this, &GalleryCompositor::cleanup);
+
+    initializeOpenGLFunctions();
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Pixel store state belongs to this context, chroma rows of odd width frames are not 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (!createProgram()) {
+        DLOG("failed to create compositor program");
+        return;
+    }
+
+    glGenVertexArrays(1, &_vertexArray);
+    glBindVertexArray(_vertexArray);
+
+    glGenBuffers(1, &_instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, rect));
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, 1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TileInstance), (void*)offsetof(TileInstance, tex));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+
+    glGenTextures(3, _textures);
+    for (int i = 0; i < 3; ++i) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textures[i]);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+}
+
+bool GalleryCompositor::createProgram()
+{
+    auto compile = [this](GLenum type, const char* source) -> GLuint {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (status == GL_FALSE) {
+            char log[512] = { 0 };
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            DLOG("compositor shader compile error: {}", log);
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    };
+
+    GLuint vertexShader = compile(GL_VERTEX_SHADER, kCompositorVertexShaderSource);
+    GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, kCompositorFragmentShaderSource);
+    if (!vertexShader || !fragmentShader) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return false;
+    }
+
+    _program = glCreateProgram();
+    glAttachShader(_program, vertexShader);
+    glAttachShader(_program, fragmentShader);
+    glLinkProgram(_program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        glDeleteProgram(_program);
+        _program = 0;
+        return false;
+    }
+
+    glUseProgram(_program);
+    glUniform1i(glGetUniformLocation(_program, "s_textureY"), 0);
+    glUniform1i(glGetUniformLocation(_program, "s_textureU"), 1);
+    glUniform1i(glGetUniformLocation(_program, "s_textureV"), 2);
+    return true;
+}
+
+void GalleryCompositor::allocateTextures(int width, int height, int layers)
+{
+    _textureWidth = alignUp(width, kTextureSizeAlignment);
+    _textureHeight = alignUp(height, kTextureSizeAlignment);
+    _textureLayers = std::min(alignUp(layers, kTextureLayerAlignment), (int)_tiles.size());
+
+    for (int i = 0; i < 3; ++i) {
+        const int w = i == 0 ? _textureWidth : _textureWidth / 2;
+        const int h = i == 0 ? _textureHeight : _textureHeight / 2;
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textures[i]);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, w, h, _textureLayers, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    // Storage is new, every layer has to be uploaded again
+    _layerSizes.assign(_textureLayers, QSize());
+    _layerOwners.assign(_textureLayers, -1);
+}
+
+void GalleryCompositor::uploadTile(int32_t layer, const webrtc::VideoFrame& frame)
+{
+    rtc::scoped_refptr<webrtc::I420BufferInterface> buffer = frame.video_frame_buffer()->ToI420();
+    if (!buffer) {
+        return;
+    }
+
+    const uint8_t* planes[3] = { buffer->DataY(), buffer->DataU(), buffer->DataV() };
+    const int strides[3] = { buffer->StrideY(), buffer->StrideU(), buffer->StrideV() };
+    for (int i = 0; i < 3; ++i) {
+        const int w = i == 0 ? buffer->width() : buffer->ChromaWidth();
+        const int h = i == 0 ? buffer->height() : buffer->ChromaHeight();
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textures[i]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, strides[i]);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, w, h, 1, GL_RED, GL_UNSIGNED_BYTE, planes[i]);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    _layerSizes[layer] = QSize(buffer->width(), buffer->height());
+}
+
+void GalleryCompositor::paintGL()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (!_program || width() == 0 || height() == 0) {
+        return;
+    }
+
+    struct Visible {
+        CompositorTile* tile;
+        const webrtc::VideoFrame* frame;
+        bool dirty;
+    };
+
+    std::vector<Visible> visibles;
+    visibles.reserve(_tiles.size());
+    int maxWidth = 0;
+    int maxHeight = 0;
+    for (const auto& tile : _tiles) {
+        if (!tile->_visible || tile->_rect.isEmpty()) {
+            continue;
+        }
+        bool dirty = false;
+        if (auto taken = tile->_mailbox.take()) {
+            if (!tile->_locked.load(std::memory_order_acquire)) {
+                tile->_frame = std::move(taken);
+                dirty = true;
+            }
+        }
+        const webrtc::VideoFrame* frame = tile->_frame.get();
+        if (!frame || frame->width() == 0 || frame->height() == 0) {
+            continue;
+        }
+        maxWidth = std::max(maxWidth, frame->width());
+        maxHeight = std::max(maxHeight, frame->height());
+        visibles.push_back({ tile.get(), frame, dirty });
+
+        const bool transposed = frame->rotation() == webrtc::kVideoRotation_90 || frame->rotation() == webrtc::kVideoRotation_270;
+        const QSize frameSize = transposed ? QSize(frame->height(), frame->width()) : QSize(frame->width(), frame->height());
+        if (frameSize != tile->_frameSize) {
+            tile->_frameSize = frameSize;
+            emit tileFrameSizeChanged(tile->_index, frameSize.width(), frameSize.height());
+        }
+    }
+
+    if (visibles.empty()) {
+        return;
+    }
+
+    if (maxWidth > _textureWidth || maxHeight > _textureHeight || (int)visibles.size() > _textureLayers) {
+        allocateTextures(std::max(maxWidth, _textureWidth), std::max(maxHeight, _textureHeight), std::max((int)visibles.size(), _textureLayers));
+    }
+
+    // Visible tile n samples layer n, a layer is uploaded again only when its frame changed or
+    // another tile moved into it
+    std::vector<TileInstance> instances;
+    instances.reserve(visibles.size());
+    const float canvasWidth = (float)width();
+    const float canvasHeight = (float)height();
+    for (int32_t layer = 0; layer < (int32_t)visibles.size(); ++layer) {
+        const auto& visible = visibles[layer];
+        const auto& frame = *visible.frame;
+        if (visible.dirty || _layerOwners[layer] != visible.tile->_index) {
+            uploadTile(layer, frame);
+            _layerOwners[layer] = visible.tile->_index;
+        }
+
+        const int rotation = (frame.rotation() + visible.tile->_rotation) % 360;
+        const bool transposed = rotation == webrtc::kVideoRotation_90 || rotation == webrtc::kVideoRotation_270;
+        const float imageRatio = transposed ? (float)frame.height() / frame.width() : (float)frame.width() / frame.height();
+
+        // Letterbox inside the cell like VideoRenderer does
+        const QRect& cell = visible.tile->_rect;
+        float w = (float)cell.width();
+        float h = (float)cell.height();
+        if (w / h >= imageRatio) {
+            w = h * imageRatio;
+        }
+        else {
+            h = w / imageRatio;
+        }
+        const float x = cell.x() + (cell.width() - w) / 2.0f;
+        const float y = cell.y() + (cell.height() - h) / 2.0f;
+
+        TileInstance instance;
+        instance.rect[0] = x / canvasWidth * 2.0f - 1.0f;
+        instance.rect[1] = 1.0f - (y + h) / canvasHeight * 2.0f;
+        instance.rect[2] = w / canvasWidth * 2.0f;
+        instance.rect[3] = h / canvasHeight * 2.0f;
+        instance.tex[0] = (float)_layerSizes[layer].width() / _textureWidth;
+        instance.tex[1] = (float)_layerSizes[layer].height() / _textureHeight;
+        instance.tex[2] = (float)layer;
+        instance.tex[3] = (float)(rotation / 90);
+        instances.push_back(instance);
+    }
+
+    glViewport(0, 0, width() * devicePixelRatioF(), height() * devicePixelRatioF());
+
+    glUseProgram(_program);
+    for (int i = 0; i < 3; ++i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textures[i]);
+    }
+
+    glBindVertexArray(_vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(TileInstance), instances.data(), GL_STREAM_DRAW);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instances.size());
+    glBindVertexArray(0);
+}
+
+void GalleryCompositor::cleanup()
+{
+    if (!_program) {
+        return;
+    }
+
+    makeCurrent();
+
+    glDeleteTextures(3, _textures);
+    glDeleteBuffers(1, &_instanceBuffer);
+    glDeleteVertexArrays(1, &_vertexArray);
+    glDeleteProgram(_program);
+    _program = 0;
+    _textureWidth = 0;
+    _textureHeight = 0;
+    _textureLayers = 0;
+    _layerSizes.clear();
+    _layerOwners.clear();
+
+    doneCurrent();
+}
@@ -0,0 +1,126 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <QRect>
+#include <QtOpenGLWidgets/QOpenGLWidget>
+#include <QOpenGLExtraFunctions>
+#include "api/video/video_sink_interface.h"
+#include "api/video/video_frame.h"
+#include "video_frame_mailbox.h"
+
+class GalleryCompositor;
+
+// Video sink of one gallery cell, the newest frame waits in a lock-free mailbox until the compositor paints it
+class CompositorTile : public rtc::VideoSinkInterface<webrtc::VideoFrame>
+{
+public:
+    CompositorTile(GalleryCompositor* compositor, int32_t index);
+
+    void clear();
+
+    void reset();
+
+    void setGeometry(const QRect& rect, bool visible);
+
+    void setRotation(uint8_t rotation);
+
+protected:
+    void OnFrame(const webrtc::VideoFrame& frame) override;
+
+private:
+    friend class GalleryCompositor;
+
+    GalleryCompositor* _compositor;
+
+    const int32_t _index;
+
+    VideoFrameMailbox _mailbox;
+
+    // Set by clear(), frames arriving meanwhile are dropped
+    std::atomic_bool _locked { false };
+
+    // GUI thread only
+    // Last frame taken from the mailbox, uploaded again when another tile used its layer
+    std::unique_ptr<webrtc::VideoFrame> _frame;
+
+    QRect _rect;
+
+    bool _visible = false;
+
+    webrtc::VideoRotation _rotation = webrtc::kVideoRotation_0;
+
+    // Last size reported through tileFrameSizeChanged
+    QSize _frameSize;
+};
+
+// Renders every visible gallery cell into one GL surface: Y, U and V planes of all tiles live in
+// three texture arrays, one layer per tile, and a single instanced draw with one shader program
+// covers the whole gallery.
+class GalleryCompositor
+    : public QOpenGLWidget
+    , public QOpenGLExtraFunctions
+{
+    Q_OBJECT
+
+public:
+    GalleryCompositor(QWidget* parent, int32_t tileCount);
+
+    ~GalleryCompositor();
+
+    CompositorTile* tile(int32_t index);
+
+    void scheduleUpdate();
+
+signals:
+    // Size of the tile's decoded frames with their own rotation applied, emitted when it changes
+    void tileFrameSizeChanged(int32_t index, int width, int height);
+
+protected:
+    void initializeGL() override;
+
+    void paintGL() override;
+
+private slots:
+    void cleanup();
+
+private:
+    bool createProgram();
+
+    void allocateTextures(int width, int height, int layers);
+
+    void uploadTile(int32_t layer, const webrtc::VideoFrame& frame);
+
+private:
+    std::vector<std::unique_ptr<CompositorTile>> _tiles;
+
+    std::atomic_bool _updatePending { false };
+
+    GLuint _program = 0;
+
+    GLuint _vertexArray = 0;
+
+    GLuint _instanceBuffer = 0;
+
+    // Y, U and V arrays
+    GLuint _textures[3] = {};
+
+    int _textureWidth = 0;
+
+    int _textureHeight = 0;
+
+    int _textureLayers = 0;
+
+    // Frame size held by each layer, used to scale texture coordinates
+    std::vector<QSize> _layerSizes;
+
+    // Tile index whose frame each layer holds, -1 when empty
+    std::vector<int32_t> _layerOwners;
+};
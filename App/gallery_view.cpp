@@ -18,6 +18,9 @@
 #define DRAG_QSS    "border:3px groove #FF8C00"
 #define RECT_QSS    "border:2px solid red"
 
+// Layouts with at least this many cells are drawn by the compositor
+#define COMPOSITOR_MIN_CELLS    16
+
 namespace {
 #ifdef _MSC_VER
     /* @see winsock2.h
@@ -99,10 +102,21 @@ void GalleryView::destroy()
 void GalleryView::initUI() {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
+    // Created first so it stays below the canvases
+    _compositor = new GalleryCompositor(this, MV_STYLE_MAXNUM);
+    _compositor->hide();
+
+    connect(_compositor, &GalleryCompositor::tileFrameSizeChanged, this, [this](int32_t index, int width, int height) {
+        if (index >= 0 && index < _canvases.size()) {
+            ((VideoCanvas*)_canvases[index])->onFrameSizeChanged(width, height);
+        }
+    }, Qt::QueuedConnection);
+
     for (int i = 0; i < MV_STYLE_MAXNUM; ++i) {
         VideoCanvas* canvas = new VideoCanvas(this);
         canvas->init();
         canvas->setId(i + 1);
+        connect(canvas, &VideoCanvas::videoSizeChanged, this, &GalleryView::preferredVideoSizeChanged);
         _canvases.push_back(canvas);
         canvas->show();
     }
@@ -122,9 +136,38 @@ void GalleryView::initUI() {
 void GalleryView::setLayout(int row, int col) {
     saveLayout();
     _table.init(row, col);
+    setCompositorMode(row * col >= COMPOSITOR_MIN_CELLS);
     updateUI();
 }
 
+void GalleryView::setCompositorMode(bool enabled) {
+    if (!_compositor || _compositorMode == enabled) {
+        return;
+    }
+    _compositorMode = enabled;
+
+    for (int i = 0; i < _canvases.size(); ++i) {
+        VideoCanvas* canvas = (VideoCanvas*)_canvases[i];
+        canvas->setCompositorTile(enabled ? _compositor->tile(i) : nullptr);
+    }
+
+    _compositor->setVisible(enabled);
+    _compositor->lower();
+    syncCompositor();
+}
+
+void GalleryView::syncCompositor() {
+    if (!_compositorMode) {
+        return;
+    }
+
+    _compositor->setGeometry(rect());
+    for (int i = 0; i < _canvases.size(); ++i) {
+        QWidget* widget = _canvases[i];
+        _compositor->tile(i)->setGeometry(widget->geometry(), widget->isVisible());
+    }
+}
+
 void GalleryView::mergeCells(int lt, int rb) {
 #if 1
     // find first non-stop player as lt
@@ -155,6 +198,8 @@ void GalleryView::exchangeCells(VideoCanvas* canvas1, VideoCanvas* canvas2) {
 
     canvas2->setGeometry(rcTmp);
     canvas2->setId(idTmp);
+
+    syncCompositor();
 }
 
 VideoCanvas* GalleryView::getCanvas(int id) {
@@ -224,12 +269,45 @@ void GalleryView::updateUI() {
     }
 
     _bStretch = (cnt == 1);
+
+    syncCompositor();
+    reportVisibleParticipants();
+}
+
+void GalleryView::reportVisibleParticipants() {
+    std::vector<std::string> pids;
+    if (isVisible()) {
+        for (int i = 0; i < _canvases.size(); ++i) {
+            VideoCanvas* canvas = (VideoCanvas*)_canvases[i];
+            if (canvas->isVisibleTo(this) && canvas->status() == VideoCanvas::ATTACHED) {
+                pids.emplace_back(canvas->pid());
+            }
+        }
+    }
+    std::sort(pids.begin(), pids.end());
+
+    if (pids == _visibleParticipants) {
+        return;
+    }
+    _visibleParticipants = pids;
+
+    emit visibleParticipantsChanged(_visibleParticipants);
 }
 
 void GalleryView::resizeEvent(QResizeEvent* e) {
     updateUI();
 }
 
+void GalleryView::showEvent(QShowEvent* e) {
+    QFrame::showEvent(e);
+    reportVisibleParticipants();
+}
+
+void GalleryView::hideEvent(QHideEvent* e) {
+    QFrame::hideEvent(e);
+    reportVisibleParticipants();
+}
+
 void GalleryView::mousePressEvent(QMouseEvent* e) {
     _ptMousePress = e->pos();
     _tsMousePress = gettick();
@@ -308,6 +386,8 @@ void GalleryView::stretch(QWidget* widget) {
         widget->setGeometry(rect());
         widget->show();
         _bStretch = true;
+        syncCompositor();
+        reportVisibleParticipants();
     }
 }
 
@@ -343,6 +423,8 @@ void GalleryView::attach(std::shared_ptr<vi::IParticipant> participant) {
             canvas->attach(participant);
         }
     }
+
+    reportVisibleParticipants();
 }
 
 
@@ -363,6 +445,8 @@ void GalleryView::detach(std::shared_ptr<vi::IParticipant> participant) {
     if (canvas) {
         canvas->detach();
     }
+
+    reportVisibleParticipants();
 }
 
 void GalleryView::update(std::shared_ptr<vi::IParticipant> participant) {
@@ -390,4 +474,6 @@ void GalleryView::reset()
         VideoCanvas* vc = (VideoCanvas*)_canvases[i];
         vc->detach();
     }
+
+    reportVisibleParticipants();
 }
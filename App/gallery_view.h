@@ -17,6 +17,7 @@
 #include "api/scoped_refptr.h"
 #include "mac_video_renderer.h"
 #include "video_renderer.h"
+#include "gallery_compositor.h"
 #include "table.h"
 #include "service/participant.h"
 
@@ -72,6 +73,7 @@ public:
         _buttonRotate = new QToolButton(this);
         connect(_buttonRotate, &QToolButton::clicked, this, &VideoCanvas::onRotateButtonClikced);
         connect(this, &VideoCanvas::rotationChanged, _renderer, &VideoRenderer::onRotateFrame);
+        connect(_renderer, &VideoRenderer::frameSizeChanged, this, &VideoCanvas::onFrameSizeChanged);
 	}
 
     void init()  {
@@ -96,7 +98,7 @@ public:
             _renderer->destroy();
 		}
         if (_track) {
-            _track->RemoveSink(_renderer);
+            _track->RemoveSink(sink());
             _track = nullptr;
         }
         _status = Status::DETACHED;
@@ -133,12 +135,12 @@ public:
     }
 
     void detach() {
-        if (_renderer && _track) {
-            _track->RemoveSink(_renderer);
+        if (_track) {
+            _track->RemoveSink(sink());
             _track = nullptr;
         }
 
-        _renderer->clear();
+        clearVideo();
 
         _labelName->setText("");
 
@@ -169,17 +171,117 @@ public:
         return _participant ? _participant->id() : "";
     }
 
+    // Frames go to the compositor tile instead of the canvas' own renderer, nullptr switches back
+    void setCompositorTile(CompositorTile* tile) {
+        if (_tile == tile) {
+            return;
+        }
+
+        if (_track) {
+            _track->RemoveSink(sink());
+        }
+        if (_tile) {
+            _tile->clear();
+        }
+
+        _tile = tile;
+        _renderer->setVisible(!_tile);
+
+        if (_tile) {
+            _tile->setRotation(_rotation);
+            if (_track) {
+                _tile->reset();
+            }
+        }
+        if (_track) {
+            _track->AddOrUpdateSink(sink(), sinkWants());
+        }
+    }
+
 signals:
     void rotationChanged(uint8_t rotation);
 
+    // Physical pixel size the participant's video is shown at, letterboxing excluded, in the
+    // orientation of the decoded frames
+    void videoSizeChanged(const std::string& pid, int width, int height);
+
+public slots:
+    // Reported by whichever of the renderer or the compositor tile draws the video
+    void onFrameSizeChanged(int width, int height) {
+        _frameSize = QSize(width, height);
+        publishVideoSize();
+    }
+
 private slots:
     void onRotateButtonClikced() {
         ++_rotation;
         _rotation = _rotation % 4;
+        if (_tile) {
+            _tile->setRotation(_rotation);
+        }
         emit rotationChanged(_rotation);
+        publishVideoSize();
     }
 
 private:
+    rtc::VideoSinkInterface<webrtc::VideoFrame>* sink() {
+        return _tile ? static_cast<rtc::VideoSinkInterface<webrtc::VideoFrame>*>(_tile) : _renderer;
+    }
+
+    void clearVideo() {
+        if (_tile) {
+            _tile->clear();
+        }
+        _renderer->clear();
+    }
+
+    void resetVideo() {
+        if (_tile) {
+            _tile->reset();
+        }
+        _renderer->reset();
+    }
+
+    QSize videoSize() {
+        const qreal ratio = devicePixelRatioF();
+        const QSize canvas(qRound(width() * ratio), qRound(height() * ratio));
+        if (_frameSize.isEmpty() || canvas.isEmpty()) {
+            return canvas;
+        }
+
+        // Letterboxed like the renderers draw it, the user rotation turns the frame on screen
+        const bool transposed = _rotation % 2 == 1;
+        QSize frame = transposed ? _frameSize.transposed() : _frameSize;
+        frame.scale(canvas, Qt::KeepAspectRatio);
+        return transposed ? frame.transposed() : frame;
+    }
+
+    // Sources never need to deliver more pixels than the canvas covers on screen
+    rtc::VideoSinkWants sinkWants() {
+        rtc::VideoSinkWants wants;
+        const QSize size = videoSize();
+        if (!size.isEmpty()) {
+            wants.max_pixel_count = size.width() * size.height();
+        }
+        wants.resolution_alignment = 2;
+        return wants;
+    }
+
+    void publishVideoSize() {
+        if (!_track) {
+            return;
+        }
+
+        const QSize size = videoSize();
+        if (size.isEmpty() || size == _publishedSize) {
+            return;
+        }
+        _publishedSize = size;
+
+        _track->AddOrUpdateSink(sink(), sinkWants());
+        emit videoSizeChanged(pid(), size.width(), size.height());
+    }
+
     void updateUI(std::shared_ptr<vi::IParticipant> participant) {
         if (!participant) {
             return;
@@ -212,19 +314,21 @@ private:
             if (!_track) {
                 _track = track;
                 if (_track) {
-                    rtc::VideoSinkWants wants;
-                    _track->AddOrUpdateSink(_renderer, wants);
-                    _renderer->reset();
+                    _track->AddOrUpdateSink(sink(), sinkWants());
+                    resetVideo();
+                    _publishedSize = QSize();
+                    publishVideoSize();
                 }
             }
             else {
                 if (_track != track) {
-                    _track->RemoveSink(_renderer);
+                    _track->RemoveSink(sink());
                     _track = track;
                     if (_track) {
-                        rtc::VideoSinkWants wants;
-                        _track->AddOrUpdateSink(_renderer, wants);
-                        _renderer->reset();
+                        _track->AddOrUpdateSink(sink(), sinkWants());
+                        resetVideo();
+                        _publishedSize = QSize();
+                        publishVideoSize();
                     }
                 }
             }
@@ -232,13 +336,13 @@ private:
 
         if (participant->isVideoMuted()) {
             if (_track) {
-                _track->RemoveSink(_renderer);
+                _track->RemoveSink(sink());
                 _track = nullptr;
             }
-            _renderer->clear();
+            clearVideo();
         }
         else {
-            _renderer->reset();
+            resetVideo();
         }
     }
 
@@ -257,6 +361,8 @@ protected:
 
         _buttonRotate->setGeometry(QRect(this->rect().left() + 10 + 300, this->rect().bottom() - 35, 30, 30));
 
+        publishVideoSize();
+
         QWidget::resizeEvent(event);
     }
 
@@ -268,6 +374,8 @@ private:
 
     VideoRenderer* _renderer;
 
+    CompositorTile* _tile = nullptr;
+
     Status _status = Status::DETACHED;
 
     std::shared_ptr<vi::IParticipant> _participant;
@@ -279,6 +387,11 @@ private:
     QProgressBar* _progressBarVolume;
 
     uint8_t _rotation {0};
+
+    // Decoded frame size as last reported, empty until the first frame
+    QSize _frameSize;
+
+    QSize _publishedSize;
 };
 
 class GalleryView : public QFrame
@@ -311,6 +424,9 @@ public:
 
     void reset();
 
+    // All visible cells are drawn by one GalleryCompositor instead of one GL widget per cell
+    void setCompositorMode(bool enabled);
+
 protected slots:
 
     void saveLayout();
@@ -323,13 +439,27 @@ protected slots:
 
     void stretch(QWidget* widget);
 
+signals:
+    void preferredVideoSizeChanged(const std::string& pid, int width, int height);
+
+    // Participants attached to a canvas that is currently shown
+    void visibleParticipantsChanged(const std::vector<std::string>& pids);
+
 protected:
     void initUI();
 
     void updateUI();
 
+    void syncCompositor();
+
+    void reportVisibleParticipants();
+
     void resizeEvent(QResizeEvent* e) override;
 
+    void showEvent(QShowEvent* e) override;
+
+    void hideEvent(QHideEvent* e) override;
+
     void mousePressEvent(QMouseEvent* e) override;
 
     void mouseReleaseEvent(QMouseEvent* e) override;
@@ -352,6 +482,13 @@ private:
 
     QVector<QWidget*> _canvases;
 
+    GalleryCompositor* _compositor = nullptr;
+
+    bool _compositorMode = false;
+
+    // Sorted, last set sent through visibleParticipantsChanged
+    std::vector<std::string> _visibleParticipants;
+
     QPoint _ptMousePress;
     uint64_t _tsMousePress;
 
@@ -1,6 +1,8 @@
 #include "mainwindow.h"
 #include <QMetaType>
 #include <QApplication>
+#include <QDir>
+#include <QStandardPaths>
 
 #include <QOpenGLFunctions>
 #include "rtc_base/thread.h"
@@ -16,6 +18,7 @@
 #include "logger/spd_logger.h"
 #include "service/core.h"
 #include "service/engine.h"
+#include "opengl/shader_program_cache.h"
 
 static void registerMetaTypes()
 {
@@ -38,6 +41,9 @@ int main(int argc, char *argv[])
 
     vi::Core::init();
 
+    // Every QOpenGLWidget joins one share group, video renderers share shader programs and textures
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+
     QApplication a(argc, argv);
 
     QSurfaceFormat format;
@@ -47,6 +53,12 @@ int main(int argc, char *argv[])
     format.setProfile(QSurfaceFormat::CoreProfile);
     QSurfaceFormat::setDefaultFormat(format);
 
+    // Linked shader programs are kept on disk, later runs skip compiling them
+    const QString shaderCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/shaders";
+    if (QDir().mkpath(shaderCacheDir)) {
+        ShaderProgramCache::setBinaryDirectory(shaderCacheDir.toLocal8Bit().toStdString());
+    }
+
     getThread("main")->PostTask([](){
         DLOG("mediasoupclient main: test");
     });
@@ -78,6 +78,16 @@ void MainWindow::init()
         _galleryView->init();
         _galleryView->setFrameShape(QFrame::Shape::Box);
         setCentralWidget(_galleryView);
+        connect(_galleryView, &GalleryView::preferredVideoSizeChanged, this, [this](const std::string& pid, int width, int height) {
+            if (auto pc = _roomClient->getParticipantController()) {
+                pc->setPreferredVideoSize(pid, width, height);
+            }
+        });
+        connect(_galleryView, &GalleryView::visibleParticipantsChanged, this, [this](const std::vector<std::string>& pids) {
+            if (auto pc = _roomClient->getParticipantController()) {
+                pc->setVisibleVideoParticipants(pids);
+            }
+        });
     }
 
     ui->toolBar->setIconSize(QSize(64, 64));
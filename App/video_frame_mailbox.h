@@ -0,0 +1,45 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "api/video/video_frame.h"
+
+// Single slot handing the newest frame from the decoder thread to the GUI thread without locks,
+// a frame still in the slot when the next one arrives is dropped.
+class VideoFrameMailbox
+{
+public:
+    VideoFrameMailbox() = default;
+
+    ~VideoFrameMailbox() {
+        delete _slot.exchange(nullptr);
+    }
+
+    // Returns true when an unconsumed frame was replaced
+    bool post(const webrtc::VideoFrame& frame) {
+        webrtc::VideoFrame* previous = _slot.exchange(new webrtc::VideoFrame(frame), std::memory_order_acq_rel);
+        if (previous) {
+            delete previous;
+            return true;
+        }
+        return false;
+    }
+
+    std::unique_ptr<webrtc::VideoFrame> take() {
+        return std::unique_ptr<webrtc::VideoFrame>(_slot.exchange(nullptr, std::memory_order_acq_rel));
+    }
+
+private:
+    VideoFrameMailbox(const VideoFrameMailbox&) = delete;
+
+    VideoFrameMailbox& operator=(const VideoFrameMailbox&) = delete;
+
+private:
+    std::atomic<webrtc::VideoFrame*> _slot { nullptr };
+};
@@ -5,7 +5,9 @@
  **/
 
 #include "opengl/video_shader.h"
-#include "opengl/i420_texture_cache.h"
+#include "opengl/video_texture_cache.h"
+#include "opengl/shader_program_cache.h"
+#include "opengl/texture_pool.h"
 #include "video_renderer.h"
 #include <thread>
 #include <array>
@@ -42,7 +44,7 @@ VideoRenderer::VideoRenderer(QWidget *parent)
     //sstr << "C:\\Users\\admin\\Documents\\GitHub\\mediasoup-client\\Debug\\test" << cnt << ".yuv";
     //_fp = fopen(sstr.str().c_str(), "wb+");
 
-    connect(this, &VideoRenderer::draw, this, &VideoRenderer::onDraw, Qt::QueuedConnection);
+    connect(this, &VideoRenderer::frameArrived, this, &VideoRenderer::onFrameArrived, Qt::QueuedConnection);
 
 }
 
@@ -68,11 +70,25 @@ void VideoRenderer::destroy()
 void VideoRenderer::clear()
 {
     _locked = true;
+    _frameSize = QSize();
+    // Lets paintGL hand the textures back to the pool
+    QWidget::update();
 }
 
 void VideoRenderer::reset()
 {
     _locked = false;
+    // The next frame reports its size again, the source may have changed meanwhile
+    _frameSize = QSize();
+}
+
+VideoRendererStats VideoRenderer::stats() const
+{
+    VideoRendererStats stats;
+    stats.received = _receivedFrames.load(std::memory_order_relaxed);
+    stats.rendered = _renderedFrames.load(std::memory_order_relaxed);
+    stats.dropped = _droppedFrames.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void VideoRenderer::initializeGL()
@@ -87,10 +103,13 @@ void VideoRenderer::initializeGL()
 
     glEnable(GL_TEXTURE_2D);
 
-    _i420TextureCache = std::make_shared<I420TextureCache>();
-    _i420TextureCache->init();
+    // Programs and textures are shared with every other renderer of the share group
+    const void* shareGroup = context()->shareGroup();
+
+    _textureCache = std::make_shared<VideoTextureCache>();
+    _textureCache->init(I420TextureCache::UploadMode::Streaming, TexturePool::forShareGroup(shareGroup));
 
-    _videoShader = std::make_shared<VideoShader>();
+    _videoShader = std::make_shared<VideoShader>(ShaderProgramCache::forShareGroup(shareGroup));
 
     // Set up the rendering context, load shaders and other resources, etc.:
     //QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
@@ -119,23 +138,14 @@ void VideoRenderer::paintGL()
             return;
         }
 
-        if (_cacheFrame->rotation() != _rotation) {
-            rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer;
-            if (vfb->type() != webrtc::VideoFrameBuffer::Type::kI420) {
-                buffer = vfb->ToI420();
-            }
-            else {
-                buffer = vfb;
-            }
-            webrtc::VideoFrame rotated_frame(*_cacheFrame.get());
-            rotated_frame.set_video_frame_buffer(webrtc::I420Buffer::Rotate(*buffer->GetI420(), _cacheFrame->rotation()));
-            rotated_frame.set_rotation(_rotation);
-            rotated_frame.set_timestamp_us(_cacheFrame->timestamp_us());
+        // The frame's own rotation and the user selected one are both applied to the texture
+        // coordinates, the buffer is never rotated on the CPU
+        const auto rotation = static_cast<webrtc::VideoRotation>((_cacheFrame->rotation() + _rotation.load()) % 360);
+        const bool transposed = rotation == webrtc::kVideoRotation_90 || rotation == webrtc::kVideoRotation_270;
+        const int32_t imageWidth = transposed ? _cacheFrame->height() : _cacheFrame->width();
+        const int32_t imageHeight = transposed ? _cacheFrame->width() : _cacheFrame->height();
 
-            _cacheFrame = std::make_shared<webrtc::VideoFrame>(rotated_frame);
-        }
-
-        float imageRatio = (float)_cacheFrame->width() / (float)_cacheFrame->height();
+        float imageRatio = (float)imageWidth / (float)imageHeight;
         float canvasRatio = (float)width() / (float)height();
 
         int32_t viewportX = 0;
@@ -157,15 +167,18 @@ void VideoRenderer::paintGL()
 
         glViewport(viewportX * devicePixelRatioF(), viewportY * devicePixelRatioF(), viewportW * devicePixelRatioF(), viewportH * devicePixelRatioF());
 
-        _i420TextureCache->uploadFrameToTextures(*_cacheFrame);
-        _videoShader->applyShadingForFrame(_cacheFrame->width(),
-            _cacheFrame->height(),
-            _cacheFrame->rotation(),
-            _i420TextureCache->yTexture(),
-            _i420TextureCache->uTexture(),
-            _i420TextureCache->vTexture());
+        if (_textureCache->uploadFrameToTextures(*_cacheFrame)) {
+            _textureCache->draw(*_videoShader, _cacheFrame->width(), _cacheFrame->height(), rotation);
+            if (_frameUpdated) {
+                _frameUpdated = false;
+                _renderedFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
     }
     else if (_locked) {
+        if (_cacheFrame) {
+            _textureCache->recycle();
+        }
         _cacheFrame = nullptr;
     }
 
@@ -174,13 +187,39 @@ void VideoRenderer::paintGL()
 
 void VideoRenderer::OnFrame(const webrtc::VideoFrame& frame)
 {
-    auto videeoFrame = std::make_shared<webrtc::VideoFrame>(frame);
-    emit draw(videeoFrame);
+    _receivedFrames.fetch_add(1, std::memory_order_relaxed);
+    if (_mailbox.post(frame)) {
+        _droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    // At most one event in the Qt queue, it picks up whatever frame is newest when it runs
+    if (!_framePending.exchange(true, std::memory_order_acq_rel)) {
+        emit frameArrived();
+    }
 }
 
-void VideoRenderer::onDraw(std::shared_ptr<webrtc::VideoFrame> frame)
+void VideoRenderer::onFrameArrived()
 {
-    _cacheFrame = frame;
+    // Cleared before taking, a frame posted from now on queues a new event
+    _framePending.store(false, std::memory_order_release);
+
+    auto frame = _mailbox.take();
+    if (!frame) {
+        return;
+    }
+    if (_frameUpdated) {
+        // Replaced before paintGL ran
+        _droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    _cacheFrame = std::move(frame);
+    _frameUpdated = true;
+
+    const bool transposed = _cacheFrame->rotation() == webrtc::kVideoRotation_90 || _cacheFrame->rotation() == webrtc::kVideoRotation_270;
+    const QSize frameSize = transposed ? QSize(_cacheFrame->height(), _cacheFrame->width()) : QSize(_cacheFrame->width(), _cacheFrame->height());
+    if (frameSize != _frameSize) {
+        _frameSize = frameSize;
+        emit frameSizeChanged(frameSize.width(), frameSize.height());
+    }
+
     QWidget::update();
 }
 
@@ -188,7 +227,7 @@ void VideoRenderer::cleanup()
 {
     makeCurrent();
 
-    _i420TextureCache = nullptr;
+    _textureCache = nullptr;
     _videoShader = nullptr;
 
     doneCurrent();
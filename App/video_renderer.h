@@ -8,9 +8,19 @@
 #include <mutex>
 #include <QtOpenGLWidgets/QOpenGLWidget>
 #include <QOpenGLFunctions>
+#include "video_frame_mailbox.h"
 
 class VideoShader;
-class I420TextureCache;
+class VideoTextureCache;
+
+struct VideoRendererStats {
+    // Frames delivered by the track
+    uint64_t received = 0;
+    // Frames drawn by paintGL
+    uint64_t rendered = 0;
+    // Frames replaced by a newer one before they were drawn
+    uint64_t dropped = 0;
+};
 
 class VideoRenderer
     : public QOpenGLWidget
@@ -33,6 +43,8 @@ public:
 
     void reset();
 
+    VideoRendererStats stats() const;
+
 protected:
     void initializeGL() override;
 
@@ -45,7 +57,10 @@ protected:
     void resizeEvent(QResizeEvent *e) override;
 
 signals:
-    void draw(std::shared_ptr<webrtc::VideoFrame> frame);
+    void frameArrived();
+
+    // Size of the decoded frames with their own rotation applied, emitted when it changes
+    void frameSizeChanged(int width, int height);
 
 public slots:
     void onRotateFrame(uint8_t rotation);
@@ -53,15 +68,31 @@ public slots:
 private slots:
     void cleanup();
 
-    void onDraw(std::shared_ptr<webrtc::VideoFrame> frame);
+    void onFrameArrived();
 
 private:
     std::shared_ptr<VideoShader> _videoShader;
 
-    std::shared_ptr<I420TextureCache> _i420TextureCache;
+    std::shared_ptr<VideoTextureCache> _textureCache;
 
     std::shared_ptr<webrtc::VideoFrame> _cacheFrame;
 
+    VideoFrameMailbox _mailbox;
+
+    // Set while a frameArrived event is queued, later frames only refresh the mailbox
+    std::atomic_bool _framePending { false };
+
+    // _cacheFrame has not been drawn yet
+    bool _frameUpdated = false;
+
+    QSize _frameSize;
+
+    std::atomic<uint64_t> _receivedFrames { 0 };
+
+    std::atomic<uint64_t> _renderedFrames { 0 };
+
+    std::atomic<uint64_t> _droppedFrames { 0 };
+
     bool _locked = false;
 
     std::atomic<webrtc::VideoRotation> _rotation { webrtc::VideoRotation::kVideoRotation_0 };
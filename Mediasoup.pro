@@ -3,3 +3,10 @@ TEMPLATE = subdirs
 SUBDIRS += \
     App \
     RoomClient
+
+# Headless renderer benchmark, needs EGL or OSMesa, and CPU-only micro benchmarks
+linux {
+    SUBDIRS += RenderBench MicroBench
+    RenderBench.depends = RoomClient
+    MicroBench.depends = RoomClient
+}
@@ -0,0 +1,37 @@
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle qt
+
+# CPU-only micro benchmarks of RoomClient hot paths, no GL or network involved
+
+DEFINES += WEBRTC_POSIX
+DEFINES += WEBRTC_LINUX
+DEFINES += ABSL_ALLOCATOR_NOTHROW=1
+
+INCLUDEPATH += $$PWD/../RoomClient \
+    $$PWD/../deps/webrtc/include \
+    $$PWD/../deps/webrtc/include/third_party \
+    $$PWD/../deps/webrtc/include/third_party/abseil-cpp \
+    $$PWD/../deps/libsdptransform/include \
+    $$PWD/../deps/rapidjson/include \
+    $$PWD/../deps/spdlog/include
+
+CONFIG(debug, debug | release) {
+    DESTDIR = $$PWD/../Debug
+    LIBS += -L$$PWD/../Debug/ -lRoomClient
+} else {
+    DESTDIR = $$PWD/../Release
+    LIBS += -L$$PWD/../Release/ -lRoomClient
+}
+
+LIBS += -L$$PWD/../deps/webrtc/lib/ -lwebrtc -lpthread -ldl
+
+SOURCES += \
+    json_codec_bench.cpp \
+    main.cpp \
+    observable_bench.cpp
+
+HEADERS += \
+    json_codec_bench.h \
+    observable_bench.h
@@ -0,0 +1,151 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#include "json_codec_bench.h"
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include "service/signaling_models.h"
+
+namespace {
+    // The largest message the signaling thread decodes per remote track, as the server sends it
+    const char* kNewConsumerRequest = R"({
+        "request": true,
+        "id": 7219383,
+        "method": "newConsumer",
+        "data": {
+            "id": "5b6a2c1e-3f0d-4f7e-9d61-2b4c8e1a7f03",
+            "peerId": "n7xq2kcw",
+            "kind": "video",
+            "type": "simulcast",
+            "producerId": "c1f0e2d3-8a4b-4c5d-9e6f-7a8b9c0d1e2f",
+            "producerPaused": false,
+            "rtpParameters": {
+                "encodings": [
+                    { "ssrc": 802119411, "maxBitrate": 1200000, "rtx": { "ssrc": 802119412 }, "scalabilityMode": "S3T3" }
+                ],
+                "codecs": [
+                    {
+                        "mimeType": "video/VP8",
+                        "clockRate": 90000,
+                        "rtcpFeedback": [
+                            { "type": "transport-cc", "parameter": "" },
+                            { "type": "ccm", "parameter": "fir" },
+                            { "type": "nack", "parameter": "" },
+                            { "type": "nack", "parameter": "pli" }
+                        ],
+                        "parameters": {},
+                        "payloadType": 101
+                    },
+                    {
+                        "mimeType": "video/rtx",
+                        "clockRate": 90000,
+                        "rtcpFeedback": [],
+                        "parameters": {},
+                        "payloadType": 102
+                    }
+                ],
+                "headerExtensions": [
+                    { "id": 1, "uri": "urn:ietf:params:rtp-hdrext:sdes:mid", "encrypt": false },
+                    { "id": 4, "uri": "http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time", "encrypt": false },
+                    { "id": 5, "uri": "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01", "encrypt": false },
+                    { "id": 11, "uri": "urn:3gpp:video-orientation", "encrypt": false },
+                    { "id": 12, "uri": "urn:ietf:params:rtp-hdrext:toffset", "encrypt": false }
+                ],
+                "mid": "3",
+                "rtcp": { "cname": "a9mDZ5xlbqgr0sHM", "mux": true, "reducedSize": true }
+            },
+            "appData": { "peerId": "n7xq2kcw" }
+        }
+    })";
+
+    using Model = signaling::NewConsumerRequest;
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<Model> domDecode(const std::string& json, std::string& error)
+    {
+        rapidjson::Document document;
+        document.Parse(json.data(), json.size());
+        if (document.HasParseError()) {
+            error = "parse error";
+            return nullptr;
+        }
+        return fromJsonValue<Model>(document, error);
+    }
+
+    template<typename Codec>
+    double timeRuns(int iterations, Codec&& codec)
+    {
+        // Warm the caches and the allocator before measuring
+        for (int i = 0; i < iterations / 10; ++i) {
+            codec();
+        }
+        const auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            codec();
+        }
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / iterations;
+    }
+
+    void printRow(const char* name, double domUs, double streamUs)
+    {
+        printf("%-10s %12.2f %12.2f %9.2fx\n", name, domUs, streamUs, domUs / streamUs);
+    }
+}
+
+int runJsonCodecBench(int iterations)
+{
+    std::string error;
+    auto model = fromJsonStream<Model>(kNewConsumerRequest, error);
+    if (!error.empty()) {
+        fprintf(stderr, "failed to decode the sample: %s\n", error.c_str());
+        return 1;
+    }
+
+    // Compact form, the way it arrives off the websocket
+    const std::string json = toJsonStream(*model);
+
+    int failures = 0;
+    std::string domError;
+    auto domModel = domDecode(json, domError);
+    if (!domModel || !domError.empty() || toJsonStream(*domModel) != json) {
+        fprintf(stderr, "document and streaming decoders disagree\n");
+        ++failures;
+    }
+    if (toJsonString(*model) != json) {
+        fprintf(stderr, "document and streaming encoders disagree\n");
+        ++failures;
+    }
+
+    size_t sink = 0;
+
+    const double domEncodeUs = timeRuns(iterations, [&]() {
+        sink += toJsonString(*model).size();
+    });
+    const double streamEncodeUs = timeRuns(iterations, [&]() {
+        sink += toJsonStream(*model).size();
+    });
+    const double domDecodeUs = timeRuns(iterations, [&]() {
+        std::string err;
+        sink += domDecode(json, err) != nullptr;
+    });
+    const double streamDecodeUs = timeRuns(iterations, [&]() {
+        std::string err;
+        sink += fromJsonStream<Model>(json, err) != nullptr;
+    });
+
+    printf("newConsumer codec, %zu bytes, %d runs\n", json.size(), iterations);
+    printf("%-10s %12s %12s %10s\n", "", "document us", "stream us", "speedup");
+    printRow("encode", domEncodeUs, streamEncodeUs);
+    printRow("decode", domDecodeUs, streamDecodeUs);
+
+    // Keeps the timed work observable to the optimizer
+    if (sink == 0) {
+        ++failures;
+    }
+
+    return failures;
+}
@@ -0,0 +1,12 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#pragma once
+
+// Times the rapidjson::Document codec (toJsonString, Parse + fromJsonValue) against the streaming one
+// (toJsonStream, fromJsonStream) on a newConsumer request. Returns non-zero when both codecs do not
+// produce the same json for the same model.
+int runJsonCodecBench(int iterations);
@@ -0,0 +1,97 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+// CPU-only micro benchmarks of RoomClient hot paths, each compares the current implementation
+// with the one it replaced, e.g.
+//
+//   MicroBench --observable 1000000 --json 20000
+//
+// Without options every benchmark runs with its default iteration count, otherwise only the named ones run.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "json_codec_bench.h"
+#include "observable_bench.h"
+
+namespace {
+    struct BenchOptions {
+        int observableIterations = 0;
+        int jsonIterations = 0;
+    };
+
+    const int kDefaultObservableIterations = 1000000;
+    const int kDefaultJsonIterations = 20000;
+
+    void printUsage()
+    {
+        printf("usage: MicroBench [--observable N] [--json N]\n");
+    }
+
+    bool parseIterations(const std::string& arg, const char* value, int& iterations)
+    {
+        iterations = atoi(value);
+        if (iterations <= 0) {
+            fprintf(stderr, "%s iterations must be positive\n", arg.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool parseOptions(int argc, char* argv[], BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                return false;
+            }
+            if (i + 1 >= argc) {
+                fprintf(stderr, "missing value for %s\n", arg.c_str());
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--observable") {
+                if (!parseIterations(arg, value, options.observableIterations)) {
+                    return false;
+                }
+            }
+            else if (arg == "--json") {
+                if (!parseIterations(arg, value, options.jsonIterations)) {
+                    return false;
+                }
+            }
+            else {
+                fprintf(stderr, "unknown option: %s\n", arg.c_str());
+                return false;
+            }
+        }
+
+        if (options.observableIterations == 0 && options.jsonIterations == 0) {
+            options.observableIterations = kDefaultObservableIterations;
+            options.jsonIterations = kDefaultJsonIterations;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    int failures = 0;
+    if (options.observableIterations > 0) {
+        failures += runObservableBench(options.observableIterations);
+    }
+    if (options.jsonIterations > 0) {
+        failures += runJsonCodecBench(options.jsonIterations);
+    }
+
+    return failures == 0 ? 0 : 2;
+}
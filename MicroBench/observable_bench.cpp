@@ -0,0 +1,192 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#include "observable_bench.h"
+#include <stdio.h>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+#include "absl/types/any.h"
+#include "rtc_base/deprecated/recursive_critical_section.h"
+#include "rtc_base/thread.h"
+#include "utils/universal_observable.hpp"
+
+namespace {
+    class ITickObserver {
+    public:
+        virtual ~ITickObserver() = default;
+
+        virtual void onTick(int64_t value) = 0;
+    };
+
+    class TickCounter : public ITickObserver {
+    public:
+        void onTick(int64_t value) override {
+            sum += value;
+            ++count;
+        }
+
+        int64_t sum = 0;
+        int64_t count = 0;
+    };
+
+    // notifyObservers as it was before the published snapshot: the list of absl::any is copied under
+    // a recursive critical section and every entry is any_cast, for every notification
+    template<typename Observer>
+    class LegacyObservable {
+    public:
+        using observer_ptr = std::shared_ptr<Observer>;
+
+        void addObserver(const observer_ptr &observer, rtc::Thread* thread) {
+            rtc::CritScope scope(&_criticalSection);
+            _observers.emplace_back(Object(observer, thread));
+        }
+
+    protected:
+        void notifyObservers(std::function<void(const observer_ptr &)> notifier) const {
+            decltype(_observers) observers;
+            {
+                rtc::CritScope scope(&_criticalSection);
+                observers = _observers;
+            }
+
+            for (const auto &observer: observers) {
+                auto var = absl::any(observer);
+                if (var.has_value()) {
+                    std::shared_ptr<Observer> obs;
+                    rtc::Thread* thread = nullptr;
+
+                    if (absl::any_cast<WeakObject>(&var)) {
+                        WeakObject wobj = absl::any_cast<WeakObject>(var);
+                        obs = wobj.observer.lock();
+                        thread = wobj.thread;
+                    } else if (absl::any_cast<Object>(&var)) {
+                        Object obj = absl::any_cast<Object>(var);
+                        obs = obj.observer;
+                        thread = obj.thread;
+                    }
+
+                    if (obs) {
+                        if (thread->IsCurrent()) {
+                            notifier(obs);
+                        }
+                        else {
+                            thread->PostTask([wobs = std::weak_ptr<Observer>(obs), notifier]() {
+                                if (auto observer = wobs.lock()) {
+                                    notifier(observer);
+                                }
+                            });
+                        }
+                    }
+                }
+            }
+        }
+
+    private:
+        template<typename T = std::shared_ptr<Observer>>
+        class InnerObject {
+        public:
+            InnerObject(std::shared_ptr<Observer> o, rtc::Thread* t)
+            : observer(o)
+            , thread(t) {
+            }
+
+            T observer;
+            rtc::Thread* thread;
+        };
+
+        using WeakObject = InnerObject<std::weak_ptr<Observer>>;
+        using Object = InnerObject<std::shared_ptr<Observer>>;
+
+        rtc::RecursiveCriticalSection _criticalSection;
+        std::list<absl::any> _observers;
+    };
+
+    class LegacyTicker : public LegacyObservable<ITickObserver> {
+    public:
+        void tick(int64_t value) {
+            notifyObservers([value](const auto& observer) {
+                observer->onTick(value);
+            });
+        }
+    };
+
+    class Ticker : public vi::UniversalObservable<ITickObserver> {
+    public:
+        void tick(int64_t value) {
+            notifyObservers([value](const auto& observer) {
+                observer->onTick(value);
+            });
+        }
+    };
+
+    const int kObserverCounts[] = { 1, 8, 64 };
+
+    template<typename Source>
+    double timeNotifications(Source& source, int iterations)
+    {
+        using Clock = std::chrono::steady_clock;
+        // Warm the caches and the allocator before measuring
+        for (int i = 0; i < iterations / 10; ++i) {
+            source.tick(i);
+        }
+        const auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            source.tick(i);
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    }
+
+    int64_t totalCount(const std::vector<std::shared_ptr<TickCounter>>& counters)
+    {
+        int64_t count = 0;
+        for (const auto& counter : counters) {
+            count += counter->count;
+        }
+        return count;
+    }
+}
+
+int runObservableBench(int iterations)
+{
+    // Observers registered on the calling thread are notified inline, which is the path both
+    // implementations share, so the difference left is the list snapshot and the per-entry cost
+    rtc::Thread* thread = rtc::ThreadManager::Instance()->WrapCurrentThread();
+
+    int failures = 0;
+
+    printf("notifyObservers, %d notifications per run\n", iterations);
+    printf("%-10s %14s %14s %10s\n", "observers", "legacy ns", "snapshot ns", "speedup");
+
+    for (int observerCount : kObserverCounts) {
+        LegacyTicker legacy;
+        Ticker ticker;
+        std::vector<std::shared_ptr<TickCounter>> legacyCounters;
+        std::vector<std::shared_ptr<TickCounter>> counters;
+        for (int i = 0; i < observerCount; ++i) {
+            legacyCounters.push_back(std::make_shared<TickCounter>());
+            legacy.addObserver(legacyCounters.back(), thread);
+            counters.push_back(std::make_shared<TickCounter>());
+            ticker.addObserver(counters.back(), thread);
+        }
+
+        const double legacyNs = timeNotifications(legacy, iterations);
+        const double snapshotNs = timeNotifications(ticker, iterations);
+
+        const bool same = totalCount(legacyCounters) == totalCount(counters);
+        if (!same) {
+            ++failures;
+        }
+
+        printf("%-10d %14.1f %14.1f %9.2fx%s\n", observerCount, legacyNs, snapshotNs, legacyNs / snapshotNs, same ? "" : "  MISMATCH");
+    }
+
+    rtc::ThreadManager::Instance()->UnwrapCurrentThread();
+
+    return failures;
+}
@@ -0,0 +1,12 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#pragma once
+
+// Times UniversalObservable::notifyObservers against the former lock + absl::any implementation
+// with 1, 8 and 64 observers living on the notifying thread. Returns non-zero when the two
+// implementations do not deliver the same number of callbacks.
+int runObservableBench(int iterations);
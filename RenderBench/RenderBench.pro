@@ -0,0 +1,42 @@
+TEMPLATE = app
+
+CONFIG += console c++17
+CONFIG -= app_bundle qt
+
+# Headless benchmark of the OpenGL video path: EGL surfaceless by default,
+# qmake CONFIG+=osmesa renders through OSMesa instead
+osmesa {
+    DEFINES += RENDER_BENCH_OSMESA
+    LIBS += -lOSMesa
+} else {
+    LIBS += -lEGL -lOpenGL
+}
+
+DEFINES += WEBRTC_POSIX
+DEFINES += WEBRTC_LINUX
+DEFINES += ABSL_ALLOCATOR_NOTHROW=1
+
+INCLUDEPATH += $$PWD/../RoomClient \
+    $$PWD/../deps/webrtc/include \
+    $$PWD/../deps/webrtc/include/third_party \
+    $$PWD/../deps/webrtc/include/third_party/abseil-cpp \
+    $$PWD/../deps/spdlog/include
+
+CONFIG(debug, debug | release) {
+    DESTDIR = $$PWD/../Debug
+    LIBS += -L$$PWD/../Debug/ -lRoomClient
+} else {
+    DESTDIR = $$PWD/../Release
+    LIBS += -L$$PWD/../Release/ -lRoomClient
+}
+
+LIBS += -L$$PWD/../deps/webrtc/lib/ -lwebrtc -lpthread -ldl
+
+SOURCES += \
+    main.cpp \
+    offscreen_context.cpp \
+    repack_bench.cpp
+
+HEADERS += \
+    offscreen_context.h \
+    repack_bench.h
@@ -0,0 +1,299 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+// Drives VideoTextureCache + VideoShader with synthetic frames in a headless context and reports
+// upload throughput, frame rate and per-frame latency, e.g.
+//
+//   RenderBench --format i420 --width 1280 --height 720 --tiles 9 --frames 600 --upload streaming
+//
+// --repack N times the plane repacker alone for N iterations per stride instead of rendering.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "offscreen_context.h"
+#include "repack_bench.h"
+#include "opengl/shader_program_cache.h"
+#include "opengl/texture_pool.h"
+#include "opengl/video_shader.h"
+#include "opengl/video_texture_cache.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "api/video/video_frame.h"
+#include "logger/spd_logger.h"
+
+namespace {
+    struct BenchOptions {
+        std::string format = "i420";
+        int width = 1280;
+        int height = 720;
+        int tiles = 1;
+        int frames = 300;
+        int warmup = 30;
+        int surfaceWidth = 1920;
+        int surfaceHeight = 1080;
+        I420TextureCache::UploadMode upload = I420TextureCache::UploadMode::Streaming;
+        int repackIterations = 0;
+    };
+
+    // Distinct buffers cycled per tile so consecutive uploads never hit the same memory
+    const int kFramePoolSize = 4;
+
+    void printUsage()
+    {
+        printf("usage: RenderBench [--format i420|nv12] [--width N] [--height N] [--tiles N]\n"
+               "                   [--frames N] [--warmup N] [--surface WxH] [--upload direct|streaming]\n"
+               "       RenderBench --repack N\n");
+    }
+
+    bool parseOptions(int argc, char* argv[], BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                return false;
+            }
+            if (i + 1 >= argc) {
+                fprintf(stderr, "missing value for %s\n", arg.c_str());
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--format") {
+                options.format = value;
+            }
+            else if (arg == "--width") {
+                options.width = atoi(value);
+            }
+            else if (arg == "--height") {
+                options.height = atoi(value);
+            }
+            else if (arg == "--tiles") {
+                options.tiles = atoi(value);
+            }
+            else if (arg == "--frames") {
+                options.frames = atoi(value);
+            }
+            else if (arg == "--warmup") {
+                options.warmup = atoi(value);
+            }
+            else if (arg == "--surface") {
+                if (sscanf(value, "%dx%d", &options.surfaceWidth, &options.surfaceHeight) != 2) {
+                    fprintf(stderr, "invalid surface size: %s\n", value);
+                    return false;
+                }
+            }
+            else if (arg == "--upload") {
+                options.upload = strcmp(value, "direct") == 0 ? I420TextureCache::UploadMode::Direct : I420TextureCache::UploadMode::Streaming;
+            }
+            else if (arg == "--repack") {
+                options.repackIterations = atoi(value);
+                if (options.repackIterations <= 0) {
+                    fprintf(stderr, "repack iterations must be positive\n");
+                    return false;
+                }
+            }
+            else {
+                fprintf(stderr, "unknown option: %s\n", arg.c_str());
+                return false;
+            }
+        }
+
+        if (options.format != "i420" && options.format != "nv12") {
+            fprintf(stderr, "unsupported format: %s\n", options.format.c_str());
+            return false;
+        }
+        if (options.width <= 0 || options.height <= 0 || options.tiles <= 0 || options.frames <= 0 || options.warmup < 0 ||
+            options.surfaceWidth <= 0 || options.surfaceHeight <= 0) {
+            fprintf(stderr, "sizes and counts must be positive\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Moving gradient, each pool entry is shifted so the content differs between frames
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> createBuffer(const BenchOptions& options, int seed)
+    {
+        const int width = options.width;
+        const int height = options.height;
+        if (options.format == "nv12") {
+            auto buffer = webrtc::NV12Buffer::Create(width, height);
+            for (int y = 0; y < height; ++y) {
+                uint8_t* row = buffer->MutableDataY() + y * buffer->StrideY();
+                for (int x = 0; x < width; ++x) {
+                    row[x] = (uint8_t)(x + y + seed * 16);
+                }
+            }
+            for (int y = 0; y < buffer->ChromaHeight(); ++y) {
+                uint8_t* row = buffer->MutableDataUV() + y * buffer->StrideUV();
+                for (int x = 0; x < buffer->ChromaWidth(); ++x) {
+                    row[2 * x] = (uint8_t)(x * 2 + seed * 8);
+                    row[2 * x + 1] = (uint8_t)(y * 2 + seed * 8);
+                }
+            }
+            return buffer;
+        }
+
+        auto buffer = webrtc::I420Buffer::Create(width, height);
+        for (int y = 0; y < height; ++y) {
+            uint8_t* row = buffer->MutableDataY() + y * buffer->StrideY();
+            for (int x = 0; x < width; ++x) {
+                row[x] = (uint8_t)(x + y + seed * 16);
+            }
+        }
+        for (int y = 0; y < buffer->ChromaHeight(); ++y) {
+            uint8_t* rowU = buffer->MutableDataU() + y * buffer->StrideU();
+            uint8_t* rowV = buffer->MutableDataV() + y * buffer->StrideV();
+            for (int x = 0; x < buffer->ChromaWidth(); ++x) {
+                rowU[x] = (uint8_t)(x * 2 + seed * 8);
+                rowV[x] = (uint8_t)(y * 2 + seed * 8);
+            }
+        }
+        return buffer;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        // Nearest rank
+        const size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    struct Tile {
+        std::shared_ptr<VideoTextureCache> textureCache;
+        std::shared_ptr<VideoShader> shader;
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    if (options.repackIterations > 0) {
+        return runRepackBench(options.repackIterations);
+    }
+
+    vi::Logger::init();
+
+    OffscreenContext context;
+    if (!context.init(options.surfaceWidth, options.surfaceHeight)) {
+        fprintf(stderr, "failed to create an offscreen GL context\n");
+        vi::Logger::destroy();
+        return 1;
+    }
+
+    std::vector<webrtc::VideoFrame> frames;
+    for (int i = 0; i < kFramePoolSize; ++i) {
+        frames.push_back(webrtc::VideoFrame::Builder()
+                         .set_video_frame_buffer(createBuffer(options, i))
+                         .set_rotation(webrtc::kVideoRotation_0)
+                         .set_timestamp_us(0)
+                         .build());
+    }
+
+    // Tiles share programs and textures the way renderers of one window do
+    auto programCache = ShaderProgramCache::forShareGroup(&context);
+    auto texturePool = TexturePool::forShareGroup(&context);
+
+    const int cols = (int)ceil(sqrt((double)options.tiles));
+    const int rows = (options.tiles + cols - 1) / cols;
+    const int cellWidth = options.surfaceWidth / cols;
+    const int cellHeight = options.surfaceHeight / rows;
+
+    std::vector<Tile> tiles(options.tiles);
+    for (int i = 0; i < options.tiles; ++i) {
+        Tile& tile = tiles[i];
+        tile.textureCache = std::make_shared<VideoTextureCache>();
+        tile.textureCache->init(options.upload, texturePool);
+        tile.shader = std::make_shared<VideoShader>(programCache);
+        tile.x = (i % cols) * cellWidth;
+        tile.y = (i / cols) * cellHeight;
+        tile.width = cellWidth;
+        tile.height = cellHeight;
+    }
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    const size_t bytesPerFrame = (size_t)options.width * options.height + 2 * (size_t)((options.width + 1) / 2) * ((options.height + 1) / 2);
+
+    std::vector<double> latencies;
+    latencies.reserve(options.frames);
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start;
+
+    for (int n = 0; n < options.warmup + options.frames; ++n) {
+        if (n == options.warmup) {
+            start = Clock::now();
+        }
+
+        const auto frameStart = Clock::now();
+
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (int i = 0; i < options.tiles; ++i) {
+            Tile& tile = tiles[i];
+            const webrtc::VideoFrame& frame = frames[(n + i) % kFramePoolSize];
+            glViewport(tile.x, tile.y, tile.width, tile.height);
+            if (tile.textureCache->uploadFrameToTextures(frame)) {
+                tile.textureCache->draw(*tile.shader, frame.width(), frame.height(), frame.rotation());
+            }
+        }
+        // Latency covers the GPU work too, not only command submission
+        glFinish();
+
+        if (n >= options.warmup) {
+            latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const GLenum error = glGetError();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    const double tileFrames = (double)options.frames * options.tiles;
+    // NV12 frames always take the direct path
+    const bool streaming = options.upload == I420TextureCache::UploadMode::Streaming && options.format == "i420";
+
+    printf("context:       %s\n", context.description().c_str());
+    printf("configuration: %s %dx%d, %d tiles on %dx%d, %s upload, %d frames\n",
+           options.format.c_str(), options.width, options.height, options.tiles,
+           options.surfaceWidth, options.surfaceHeight, streaming ? "streaming" : "direct", options.frames);
+    printf("frames/s:      %.1f (%.1f tile frames/s)\n", options.frames / seconds, tileFrames / seconds);
+    printf("upload MB/s:   %.1f\n", tileFrames * bytesPerFrame / seconds / (1024.0 * 1024.0));
+    printf("latency ms:    p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+           percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99), latencies.back());
+    if (error != GL_NO_ERROR) {
+        printf("GL error:      0x%x\n", error);
+    }
+
+    // GL objects go away while the context is still current
+    tiles.clear();
+    programCache = nullptr;
+    texturePool = nullptr;
+    context.destroy();
+
+    vi::Logger::destroy();
+
+    return error == GL_NO_ERROR ? 0 : 2;
+}
@@ -0,0 +1,206 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#include "offscreen_context.h"
+#include <stdio.h>
+#include <vector>
+#ifdef RENDER_BENCH_OSMESA
+#include <GL/osmesa.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+struct OffscreenContext::Platform {
+#ifdef RENDER_BENCH_OSMESA
+    OSMesaContext context = nullptr;
+    // OSMesa always needs a color buffer to make the context current, the framebuffer object is
+    // what gets rendered to
+    std::vector<uint8_t> buffer;
+#else
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+#endif
+};
+
+OffscreenContext::OffscreenContext()
+    : _platform(new Platform())
+{
+
+}
+
+OffscreenContext::~OffscreenContext()
+{
+    destroy();
+}
+
+bool OffscreenContext::init(int width, int height)
+{
+    _width = width;
+    _height = height;
+
+    if (!createContext()) {
+        return false;
+    }
+    if (!createFramebuffer()) {
+        destroyContext();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenContext::destroy()
+{
+    if (_framebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &_framebuffer);
+        glDeleteRenderbuffers(1, &_colorBuffer);
+        _framebuffer = 0;
+        _colorBuffer = 0;
+    }
+    destroyContext();
+}
+
+std::string OffscreenContext::description() const
+{
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    const GLubyte* version = glGetString(GL_VERSION);
+    std::string result = renderer ? reinterpret_cast<const char*>(renderer) : "unknown renderer";
+    result += ", ";
+    result += version ? reinterpret_cast<const char*>(version) : "unknown version";
+    return result;
+}
+
+#ifdef RENDER_BENCH_OSMESA
+
+bool OffscreenContext::createContext()
+{
+    const int attribs[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 0,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    _platform->context = OSMesaCreateContextAttribs(attribs, nullptr);
+    if (!_platform->context) {
+        fprintf(stderr, "OSMesaCreateContextAttribs failed\n");
+        return false;
+    }
+
+    _platform->buffer.resize((size_t)_width * _height * 4);
+    if (!OSMesaMakeCurrent(_platform->context, _platform->buffer.data(), GL_UNSIGNED_BYTE, _width, _height)) {
+        fprintf(stderr, "OSMesaMakeCurrent failed\n");
+        destroyContext();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenContext::destroyContext()
+{
+    if (_platform->context) {
+        OSMesaDestroyContext(_platform->context);
+        _platform->context = nullptr;
+    }
+    _platform->buffer.clear();
+}
+
+#else
+
+bool OffscreenContext::createContext()
+{
+    // The surfaceless platform needs neither a GPU nor a display server, llvmpipe renders on the CPU
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        _platform->display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (_platform->display == EGL_NO_DISPLAY) {
+        _platform->display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (_platform->display == EGL_NO_DISPLAY || !eglInitialize(_platform->display, nullptr, nullptr)) {
+        fprintf(stderr, "eglInitialize failed: 0x%x\n", eglGetError());
+        _platform->display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "eglBindAPI failed: 0x%x\n", eglGetError());
+        destroyContext();
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(_platform->display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        // Surfaceless displays may expose configs without surface types at all
+        config = nullptr;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    _platform->context = eglCreateContext(_platform->display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (_platform->context == EGL_NO_CONTEXT) {
+        fprintf(stderr, "eglCreateContext failed: 0x%x\n", eglGetError());
+        destroyContext();
+        return false;
+    }
+
+    if (!eglMakeCurrent(_platform->display, EGL_NO_SURFACE, EGL_NO_SURFACE, _platform->context)) {
+        fprintf(stderr, "eglMakeCurrent failed: 0x%x\n", eglGetError());
+        destroyContext();
+        return false;
+    }
+    return true;
+}
+
+void OffscreenContext::destroyContext()
+{
+    if (_platform->display == EGL_NO_DISPLAY) {
+        return;
+    }
+    eglMakeCurrent(_platform->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_platform->context != EGL_NO_CONTEXT) {
+        eglDestroyContext(_platform->display, _platform->context);
+        _platform->context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(_platform->display);
+    _platform->display = EGL_NO_DISPLAY;
+}
+
+#endif
+
+bool OffscreenContext::createFramebuffer()
+{
+    glGenRenderbuffers(1, &_colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, _colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, _width, _height);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorBuffer);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "framebuffer is incomplete\n");
+        return false;
+    }
+
+    glViewport(0, 0, _width, _height);
+    return true;
+}
@@ -0,0 +1,53 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "opengl/gl_defines.h"
+
+// GL 3.3+ core context without a window: EGL on a surfaceless Mesa display by default, OSMesa when
+// built with CONFIG+=osmesa. Rendering goes to a framebuffer object of the requested size.
+class OffscreenContext
+{
+public:
+    OffscreenContext();
+
+    ~OffscreenContext();
+
+    // Creates the context, makes it current and binds a width x height framebuffer
+    bool init(int width, int height);
+
+    void destroy();
+
+    // Renderer and version strings of the current context
+    std::string description() const;
+
+    int width() const { return _width; }
+
+    int height() const { return _height; }
+
+private:
+    bool createContext();
+
+    void destroyContext();
+
+    bool createFramebuffer();
+
+private:
+    struct Platform;
+
+    std::unique_ptr<Platform> _platform;
+
+    int _width = 0;
+
+    int _height = 0;
+
+    GLuint _framebuffer = 0;
+
+    GLuint _colorBuffer = 0;
+};
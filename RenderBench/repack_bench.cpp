@@ -0,0 +1,129 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#include "repack_bench.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "opengl/plane_repacker.h"
+
+namespace {
+    struct StrideCase {
+        int width;
+        int height;
+        int stride;
+    };
+
+    // Decoders and capturers pad rows to their own alignment, these are the strides seen in practice
+    const StrideCase kCases[] = {
+        { 640, 360, 704 },
+        { 1280, 720, 1344 },
+        { 1920, 1080, 2048 },
+    };
+
+    struct PaddedFrame {
+        std::vector<uint8_t> y;
+        std::vector<uint8_t> u;
+        std::vector<uint8_t> v;
+        int strideY = 0;
+        int strideUV = 0;
+    };
+
+    PaddedFrame createFrame(const StrideCase& c)
+    {
+        PaddedFrame frame;
+        const int chromaHeight = (c.height + 1) / 2;
+        frame.strideY = c.stride;
+        frame.strideUV = c.stride / 2;
+        frame.y.resize((size_t)frame.strideY * c.height);
+        frame.u.resize((size_t)frame.strideUV * chromaHeight);
+        frame.v.resize((size_t)frame.strideUV * chromaHeight);
+        for (size_t i = 0; i < frame.y.size(); ++i) {
+            frame.y[i] = (uint8_t)(i * 7);
+        }
+        for (size_t i = 0; i < frame.u.size(); ++i) {
+            frame.u[i] = (uint8_t)(i * 3);
+            frame.v[i] = (uint8_t)(i * 5);
+        }
+        return frame;
+    }
+
+    void repack(uint8_t* dst, const PaddedFrame& frame, const StrideCase& c)
+    {
+        PlaneRepacker::copyI420(dst,
+            frame.y.data(), frame.strideY,
+            frame.u.data(), frame.strideUV,
+            frame.v.data(), frame.strideUV,
+            c.width, c.height);
+    }
+
+    void copyReference(uint8_t* dst, const uint8_t* src, size_t width, size_t height, int stride)
+    {
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                *dst++ = src[y * stride + x];
+            }
+        }
+    }
+
+    template <typename Copy>
+    double measure(int iterations, Copy&& copy)
+    {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            copy();
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void report(const StrideCase& c, const char* name, double seconds, int iterations, size_t bytes, bool same)
+    {
+        printf("%4dx%-4d stride %4d  %-7s  %8.3f us/frame  %6.2f GB/s%s\n",
+               c.width, c.height, c.stride, name,
+               seconds * 1e6 / iterations, (double)bytes * iterations / seconds / 1e9,
+               same ? "" : "  MISMATCH");
+    }
+}
+
+int runRepackBench(int iterations)
+{
+    int mismatches = 0;
+
+    printf("repack:        %d iterations per case\n", iterations);
+
+    for (const StrideCase& c : kCases) {
+        const PaddedFrame frame = createFrame(c);
+        const size_t chromaWidth = (c.width + 1) / 2;
+        const size_t chromaHeight = (c.height + 1) / 2;
+        const size_t lumaSize = (size_t)c.width * c.height;
+        const size_t chromaSize = chromaWidth * chromaHeight;
+        const size_t packedSize = lumaSize + 2 * chromaSize;
+
+        std::vector<uint8_t> reference(packedSize);
+        copyReference(reference.data(), frame.y.data(), c.width, c.height, frame.strideY);
+        copyReference(reference.data() + lumaSize, frame.u.data(), chromaWidth, chromaHeight, frame.strideUV);
+        copyReference(reference.data() + lumaSize + chromaSize, frame.v.data(), chromaWidth, chromaHeight, frame.strideUV);
+
+        AlignedStagingBuffer staging;
+        uint8_t* dst = staging.reserve(packedSize);
+        repack(dst, frame, c);
+        const bool same = memcmp(dst, reference.data(), packedSize) == 0;
+        if (!same) {
+            ++mismatches;
+        }
+
+        const double repackSeconds = measure(iterations, [&]() { repack(dst, frame, c); });
+        report(c, "repack", repackSeconds, iterations, packedSize, same);
+
+        // Copying the packed bytes in one go is the ceiling the row by row repack can reach
+        const double memcpySeconds = measure(iterations, [&]() { memcpy(dst, reference.data(), packedSize); });
+        report(c, "memcpy", memcpySeconds, iterations, packedSize, true);
+    }
+
+    return mismatches == 0 ? 0 : 2;
+}
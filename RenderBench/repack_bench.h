@@ -0,0 +1,12 @@
+/**
+ * This file is part of mediasoup_client project.
+ * Author:    Jackie Ou
+ * Created:   2021-11-01
+ **/
+
+#pragma once
+
+// Times PlaneRepacker::copyI420 into an aligned staging buffer for common width / stride pairs next to
+// one contiguous memcpy of the same size, no GL context involved. Returns non-zero when the packed
+// output differs from a plane by plane reference copy.
+int runRepackBench(int iterations);
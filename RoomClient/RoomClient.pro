@@ -19,6 +19,7 @@ INCLUDEPATH += \
     $$PWD/../deps/webrtc/include/third_party \
     $$PWD/../deps/webrtc/include/third_party/abseil-cpp \
     $$PWD/../deps/webrtc/include/third_party/boringssl/src/include \
+    $$PWD/../deps/webrtc/include/third_party/libyuv/include \
     $$PWD/../deps/webrtc/include/sdk/objc \
     $$PWD/../deps/webrtc/include/sdk/objc/base \
     $$PWD/../deps/libsdptransform/include \
@@ -80,12 +81,20 @@ SOURCES += \
     network/network_request_plugin.cpp \
     network/network_request_task.cpp \
     network/network_status_detector.cpp \
+    opengl/i010_texture_cache.cpp \
     opengl/i420_texture_cache.cpp \
+    opengl/nv12_texture_cache.cpp \
+    opengl/plane_repacker.cpp \
+    opengl/shader_program_cache.cpp \
+    opengl/texture_pool.cpp \
     opengl/video_shader.cpp \
+    opengl/video_texture_cache.cpp \
     service/base_video_capturer.cc \
     service/broadcaster.cpp \
+    service/capture_buffer_pool.cpp \
     service/core.cpp \
     service/engine.cpp \
+    service/frame_fanout.cpp \
     service/component_factory.cpp \
     service/media_controller.cpp \
     service/mediasoup_api.cpp \
@@ -96,13 +105,18 @@ SOURCES += \
     service/signaling_client.cpp \
     service/service_factory.cpp \
     service/signaling_models.cpp \
+    service/simulcast_profile.cpp \
     utils/bad_any_cast.cc \
     utils/notification_center.cpp \
     utils/notification_keys.cpp \
     utils/sdp_utils.cpp \
     utils/string_utils.cpp \
     utils/task_scheduler.cpp \
+    utils/thread_dispatch_queue.cpp \
     utils/thread_provider.cpp \
+    websocket/pending_request_table.cpp \
+    websocket/request_latency_stats.cpp \
+    websocket/request_timer_wheel.cpp \
     websocket/tls_websocket_endpoint.cpp \
     websocket/websocket_endpoint.cpp
 
@@ -110,10 +124,14 @@ win: {
     SOURCES += service/windows_capture.cpp
 }
 
-unix: {
+mac: {
     SOURCES += service/mac_capturer.mm
 }
 
+linux: {
+    SOURCES += service/linux_capturer.cpp
+}
+
 HEADERS += \
     ../deps/libmediasoupclient/include/Consumer.hpp \
     ../deps/libmediasoupclient/include/DataConsumer.hpp \
@@ -135,8 +153,11 @@ HEADERS += \
     ../deps/libmediasoupclient/include/version.hpp \
     ../deps/libsdptransform/include/json.hpp \
     ../deps/libsdptransform/include/sdptransform.hpp \
+    json/json_arena.hpp \
+    json/json_bridge.hpp \
     json/jsonable.hpp \
     json/serialization.hpp \
+    json/stream_codec.hpp \
     json/string_algo.hpp \
     json/stringable.hpp \
     logger/rtc_log_sink.h \
@@ -152,12 +173,21 @@ HEADERS += \
     network/network_request_task.h \
     network/network_status_detector.h \
     opengl/gl_defines.h \
+    opengl/i010_texture_cache.h \
     opengl/i420_texture_cache.h \
+    opengl/nv12_texture_cache.h \
+    opengl/plane_repacker.h \
+    opengl/shader_program_cache.h \
+    opengl/texture_pool.h \
     opengl/video_shader.h \
+    opengl/video_texture_cache.h \
     service/base_video_capturer.h \
     service/broadcaster.hpp \
+    service/capture_buffer_pool.h \
     service/core.h \
     service/engine.h \
+    service/frame_fanout.h \
+    service/frame_size_probe.h \
     service/component_factory.h \
     service/i_media_controller.h \
     service/i_media_event_handler.h \
@@ -179,6 +209,7 @@ HEADERS += \
     service/rtc_context.hpp \
     service/signaling_client.h \
     service/signaling_models.h \
+    service/simulcast_profile.h \
     service/i_service.hpp \
     service/service_factory.hpp \
     utils/container.hpp \
@@ -195,12 +226,17 @@ HEADERS += \
     utils/singleton.h \
     utils/string_utils.h \
     utils/task_scheduler.h \
+    utils/thread_dispatch_queue.h \
     utils/thread_provider.h \
     utils/universal_observable.hpp \
     websocket/connection_metadata.h \
     websocket/i_connection_observer.h \
+    websocket/inbound_message.h \
     websocket/i_transport.h \
     websocket/i_transport_observer.h \
+    websocket/pending_request_table.h \
+    websocket/request_latency_stats.h \
+    websocket/request_timer_wheel.h \
     websocket/tls_websocket_endpoint.h \
     websocket/websocket_endpoint.h \
     websocket/websocket_request.h \
@@ -211,10 +247,14 @@ win: {
     HEADERS += service/windows_capture.h
 }
 
-unix: {
+mac: {
     HEADERS += service/mac_capturer.h
 }
 
+linux: {
+    HEADERS += service/linux_capturer.h
+}
+
 # Default rules for deployment.
 unix {
     target.path = $$[QT_INSTALL_PLUGINS]/generic
@@ -286,6 +326,9 @@ win32 {
 }
 
 linux {
-
+    DEFINES += WEBRTC_LINUX
+    DEFINES += WEBRTC_POSIX
+    DEFINES += ABSL_ALLOCATOR_NOTHROW=1
+    DEFINES += ASIO_STANDALONE
 }
 
@@ -0,0 +1,98 @@
+/*
+    Per-thread arena for parsing signaling messages.
+
+    Every thread owns a MemoryPoolAllocator backed by a preallocated buffer, documents and reader
+    stacks parsed inside a JsonArenaScope take their memory from it, the pool is reset when the
+    outermost scope on the thread ends. Typical notifications fit in the buffer so parsing them
+    does not touch malloc.
+
+    void onMessage(const std::string& json)
+    {
+        rapidjson::JsonArenaScope scope;
+        rapidjson::ArenaDocument doc(&scope.allocator(), scope.stackCapacity(), &scope.stackAllocator());
+        doc.Parse(json.c_str(), json.size());
+        ...
+    }   // doc must not outlive the scope
+*/
+#pragma once
+
+#include <rapidjson/document.h>
+
+namespace rapidjson {
+
+using ArenaDocument = GenericDocument<UTF8<>, MemoryPoolAllocator<>, MemoryPoolAllocator<>>;
+
+class JsonArena {
+public:
+    static constexpr size_t kBufferSize = 16 * 1024;
+
+    static constexpr size_t kStackBufferSize = 4 * 1024;
+
+    // Initial parser stack. The stack grows by half each time it fills, starting at a quarter of
+    // the buffer lets it grow twice in place (1K, 1.5K, 2.25K) before spilling to the heap
+    static constexpr size_t kStackCapacity = kStackBufferSize / 4;
+
+    static JsonArena& current() {
+        thread_local JsonArena arena;
+        return arena;
+    }
+
+    MemoryPoolAllocator<>& allocator() { return _allocator; }
+
+    MemoryPoolAllocator<>& stackAllocator() { return _stackAllocator; }
+
+    // Scopes nest when an observer parses synchronously while an outer document is alive,
+    // only the outermost one releases the memory
+    void enter() { ++_depth; }
+
+    void leave() {
+        if (_depth > 0 && --_depth == 0) {
+            _allocator.Clear();
+            _stackAllocator.Clear();
+        }
+    }
+
+private:
+    JsonArena()
+        : _allocator(_buffer, sizeof(_buffer), kBufferSize)
+        , _stackAllocator(_stackBuffer, sizeof(_stackBuffer), kStackBufferSize) {}
+
+    JsonArena(const JsonArena&) = delete;
+
+    JsonArena& operator=(const JsonArena&) = delete;
+
+private:
+    alignas(8) char _buffer[kBufferSize];
+    alignas(8) char _stackBuffer[kStackBufferSize];
+    MemoryPoolAllocator<> _allocator;
+    MemoryPoolAllocator<> _stackAllocator;
+    size_t _depth = 0;
+};
+
+class JsonArenaScope {
+public:
+    JsonArenaScope()
+        : _arena(JsonArena::current()) {
+        _arena.enter();
+    }
+
+    ~JsonArenaScope() {
+        _arena.leave();
+    }
+
+    MemoryPoolAllocator<>& allocator() { return _arena.allocator(); }
+
+    MemoryPoolAllocator<>& stackAllocator() { return _arena.stackAllocator(); }
+
+    size_t stackCapacity() const { return JsonArena::kStackCapacity; }
+
+private:
+    JsonArenaScope(const JsonArenaScope&) = delete;
+
+    JsonArenaScope& operator=(const JsonArenaScope&) = delete;
+
+private:
+    JsonArena& _arena;
+};
+
+}
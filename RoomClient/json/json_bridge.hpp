@@ -0,0 +1,224 @@
+/*
+    Direct conversion between the FIELDS_MAP models and nlohmann::json used by libmediasoupclient,
+    without serializing to a string and parsing it back.
+
+    models are emitted through JsonStreamCodec into a Writer-like builder that grows an nlohmann tree,
+    nlohmann trees are walked by a pull reader feeding the same codec.
+
+    void main()
+    {
+        nlohmann::json rtpParameters = toNlohmannJson(*request->data->rtpParameters);
+
+        std::string err;
+        auto dtls = fromNlohmannJson<signaling::ConnectWebRtcTransportRequest::DTLSParameters>(dtlsParameters, err);
+    }
+*/
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "stream_codec.hpp"
+
+namespace rapidjson {
+
+//rapidjson Writer-like handler that builds an nlohmann::json tree
+class NlohmannJsonBuilder {
+public:
+    bool Null() { return add(nullptr); }
+    bool Bool(bool b) { return add(b); }
+    bool Int(int i) { return add(i); }
+    bool Uint(unsigned u) { return add(u); }
+    bool Int64(int64_t i) { return add(i); }
+    bool Uint64(uint64_t u) { return add(u); }
+    bool Double(double d) { return add(d); }
+    bool String(const char* str, SizeType length, bool = false) { return add(std::string(str, length)); }
+    bool Key(const char* str, SizeType length, bool = false) { _key.assign(str, length); return true; }
+    bool StartObject() { return open(nlohmann::json::object()); }
+    bool EndObject(SizeType = 0) { _stack.pop_back(); return true; }
+    bool StartArray() { return open(nlohmann::json::array()); }
+    bool EndArray(SizeType = 0) { _stack.pop_back(); return true; }
+
+    nlohmann::json& result() { return _root; }
+
+private:
+    nlohmann::json* insert(nlohmann::json&& value) {
+        if (_stack.empty()) {
+            _root = std::move(value);
+            return &_root;
+        }
+        auto& parent = *_stack.back();
+        if (parent.is_array()) {
+            parent.emplace_back(std::move(value));
+            return &parent.back();
+        }
+        auto& slot = parent[_key];
+        slot = std::move(value);
+        return &slot;
+    }
+
+    bool add(nlohmann::json&& value) {
+        insert(std::move(value));
+        return true;
+    }
+
+    bool open(nlohmann::json&& container) {
+        // Only the innermost open containers are referenced, appending to an array never
+        // invalidates them since earlier siblings are already closed
+        _stack.emplace_back(insert(std::move(container)));
+        return true;
+    }
+
+private:
+    nlohmann::json _root;
+    std::vector<nlohmann::json*> _stack;
+    std::string _key;
+};
+
+//pull reader walking an nlohmann::json tree, same interface as JsonPullReader
+class NlohmannPullReader {
+public:
+    using Token = JsonToken;
+
+    explicit NlohmannPullReader(const nlohmann::json& root)
+        : _root(root) {}
+
+    bool next() {
+        _token = Token::None;
+        if (!_started) {
+            _started = true;
+            emit(_root);
+            return true;
+        }
+        if (_stack.empty()) {
+            return false;
+        }
+
+        auto& frame = _stack.back();
+        if (frame.it == frame.node->cend()) {
+            _token = frame.node->is_object() ? Token::EndObject : Token::EndArray;
+            _stack.pop_back();
+            return true;
+        }
+        if (frame.node->is_object() && !frame.keyEmitted) {
+            frame.keyEmitted = true;
+            _token = Token::Key;
+            _string = frame.it.key();
+            return true;
+        }
+
+        const nlohmann::json& value = *frame.it;
+        ++frame.it;
+        frame.keyEmitted = false;
+        emit(value);
+        return true;
+    }
+
+    // Skips the value whose first token is the current one
+    void skip() {
+        if (_token != Token::StartObject && _token != Token::StartArray) {
+            return;
+        }
+        // The container frame is on top of the stack, drop it without visiting its children
+        _token = _stack.back().node->is_object() ? Token::EndObject : Token::EndArray;
+        _stack.pop_back();
+    }
+
+    Token token() const { return _token; }
+
+    bool hasError() const { return false; }
+
+    int errorCode() const { return 0; }
+
+    bool boolValue() const { return _bool; }
+
+    int64_t int64Value() const { return _int64; }
+
+    uint64_t uint64Value() const { return _uint64; }
+
+    double doubleValue() const { return _double; }
+
+    const std::string& stringValue() const { return _string; }
+
+private:
+    void emit(const nlohmann::json& value) {
+        switch (value.type()) {
+        case nlohmann::json::value_t::object:
+            _token = Token::StartObject;
+            _stack.push_back({ &value, value.cbegin(), false });
+            break;
+        case nlohmann::json::value_t::array:
+            _token = Token::StartArray;
+            _stack.push_back({ &value, value.cbegin(), false });
+            break;
+        case nlohmann::json::value_t::string:
+            _token = Token::String;
+            _string = value.get_ref<const std::string&>();
+            break;
+        case nlohmann::json::value_t::boolean:
+            _token = Token::Bool;
+            _bool = value.get<bool>();
+            break;
+        case nlohmann::json::value_t::number_integer:
+            _token = Token::Int64;
+            _int64 = value.get<int64_t>();
+            _uint64 = (uint64_t)_int64;
+            _double = (double)_int64;
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            _token = Token::Uint64;
+            _uint64 = value.get<uint64_t>();
+            _int64 = (int64_t)_uint64;
+            _double = (double)_uint64;
+            break;
+        case nlohmann::json::value_t::number_float:
+            _token = Token::Double;
+            _double = value.get<double>();
+            break;
+        default:
+            _token = Token::Null;
+            break;
+        }
+    }
+
+private:
+    struct Frame {
+        const nlohmann::json* node;
+        nlohmann::json::const_iterator it;
+        bool keyEmitted;
+    };
+
+    const nlohmann::json& _root;
+    std::vector<Frame> _stack;
+    bool _started = false;
+    Token _token = Token::None;
+    bool _bool = false;
+    int64_t _int64 = 0;
+    uint64_t _uint64 = 0;
+    double _double = 0.0;
+    std::string _string;
+};
+
+}
+
+template<typename Type>
+inline nlohmann::json toNlohmannJson(const Type& value) {
+    rapidjson::NlohmannJsonBuilder builder;
+    rapidjson::JsonStreamCodec<Type>::write(builder, value);
+    return std::move(builder.result());
+}
+
+template<typename Type>
+inline std::shared_ptr<Type> fromNlohmannJson(const nlohmann::json& json, std::string& error) {
+    std::shared_ptr<Type> object = std::make_shared<Type>();
+    rapidjson::NlohmannPullReader reader(json);
+    try {
+        reader.next();
+        rapidjson::JsonStreamCodec<Type>::read(reader, "document", *object);
+    }
+    catch (const JsonStreamTypeMismatch& e) {
+        error = e.what();
+    }
+    return object;
+}
@@ -4,19 +4,22 @@
 #include <memory>
 #include "absl/types/optional.h"
 #include "serialization.hpp"
+#include "stream_codec.hpp"
 
 #define FIELDS_MAP(...)   \
 JSON_SERIALIZE(__VA_ARGS__) \
+JSON_STREAM(__VA_ARGS__) \
 MODEL_2_STRING()  \
 STRING_2_MODEL()
 
 
 #define FIELDS_MAP_NO_DSERIALIZE(...)   \
 JSON_NO_DSERIALIZE(__VA_ARGS__) \
+JSON_STREAM_ENCODE(__VA_ARGS__) \
 MODEL_2_STRING()  \
 STRING_2_MODEL()
 
-#define MODEL_2_STRING() virtual std::string toJsonStr() { return toJsonString(*this); }
+#define MODEL_2_STRING() virtual std::string toJsonStr() { return toJsonStream(*this); }
 #define STRING_2_MODEL() virtual rapidjson::Document toJsonOject() { return toJson(*this); }
 
 namespace vi {
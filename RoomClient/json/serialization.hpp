@@ -52,6 +52,7 @@
 #pragma once
 
 #include "absl/types/optional.h"
+#include "absl/strings/string_view.h"
 #include "stringable.hpp"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
@@ -62,6 +63,7 @@
 #include <map>
 #include <stdexcept>
 #include "string_algo.hpp"
+#include "json_arena.hpp"
 
 class JsonParsingFailed : public std::runtime_error
 {
@@ -574,10 +576,15 @@ inline std::shared_ptr<Type> fromJsonString(const std::string& data, bool bCheck
 }
 
 template<typename Type>
-inline std::shared_ptr<Type> fromJsonString(const std::string& data, std::string& error) {
+inline std::shared_ptr<Type> fromJsonString(absl::string_view data, std::string& error) {
     std::shared_ptr<Type> object = std::make_shared<Type>();
+    rapidjson::JsonArenaScope scope;
     try {
-        rapidjson::Document json = stringToJson(data);
+        rapidjson::ArenaDocument json(&scope.allocator(), scope.stackCapacity(), &scope.stackAllocator());
+        json.Parse(data.data(), data.size());
+        if (json.HasParseError()) {
+            throw JsonParsingFailed(std::string(data), json.GetParseError());
+        }
         object->jdeserialize(json);
     }
     catch (const JsonMissingKey& e) {
@@ -589,7 +596,28 @@ inline std::shared_ptr<Type> fromJsonString(const std::string& data, std::string
     catch (const JsonParsingFailed& e) {
         error = e.what();
     }
-    
+
+    return object;
+}
+
+template<typename Type>
+inline std::shared_ptr<Type> fromJsonString(const std::string& data, std::string& error) {
+    return fromJsonString<Type>(absl::string_view(data), error);
+}
+
+template<typename Type>
+inline std::shared_ptr<Type> fromJsonValue(const rapidjson::Value& json, std::string& error) {
+    std::shared_ptr<Type> object = std::make_shared<Type>();
+    try {
+        object->jdeserialize(json);
+    }
+    catch (const JsonMissingKey& e) {
+        error = e.what();
+    }
+    catch (const JsonTypeMismatch& e) {
+        error = e.what();
+    }
+
     return object;
 }
 
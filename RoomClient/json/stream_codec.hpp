@@ -0,0 +1,472 @@
+/*
+    Streaming json codec for the FIELDS_MAP models, no intermediate rapidjson::Document is built.
+
+    Encoding walks the declared fields and emits them straight into a rapidjson::Writer,
+    decoding pulls tokens from rapidjson's iterative reader and assigns them directly
+    into the declared fields, unknown keys are skipped.
+
+    struct B
+    {
+        absl::optional<int64_t> id;
+        absl::optional<std::string> name;
+        FIELDS_MAP("id", id, "name", name)
+    };
+
+    void main()
+    {
+        B b;
+        std::string json = toJsonStream(b);
+
+        std::string err;
+        auto b2 = fromJsonStream<B>(json, err);
+    }
+*/
+#pragma once
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "absl/types/optional.h"
+#include "absl/strings/string_view.h"
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/memorystream.h>
+#include "json_arena.hpp"
+
+class JsonStreamTypeMismatch : public std::runtime_error
+{
+public:
+    JsonStreamTypeMismatch(const std::string& name)
+        : std::runtime_error("JsonStreamTypeMismatch:" + name)
+    {}
+};
+
+namespace rapidjson {
+
+//tokens produced by the pull readers consumed by JsonStreamCodec
+enum class JsonToken { None, Null, Bool, Int, Uint, Int64, Uint64, Double, String, Key, StartObject, EndObject, StartArray, EndArray };
+
+//pull parser on top of rapidjson's iterative reader, one SAX event per next().
+//the reader stack lives in the per-thread JsonArena
+class JsonPullReader {
+public:
+    using Token = JsonToken;
+
+    JsonPullReader(const char* data, size_t size)
+        : _stream(data, size)
+        , _reader(&_scope.stackAllocator(), _scope.stackCapacity()) {
+        _reader.IterativeParseInit();
+    }
+
+    bool next() {
+        _token = Token::None;
+        if (_reader.IterativeParseComplete()) {
+            return false;
+        }
+        if (!_reader.IterativeParseNext<kParseDefaultFlags>(_stream, *this)) {
+            return false;
+        }
+        return _token != Token::None;
+    }
+
+    // Skips the value whose first token is the current one
+    void skip() {
+        if (_token != Token::StartObject && _token != Token::StartArray) {
+            return;
+        }
+        int depth = 1;
+        while (depth > 0 && next()) {
+            if (_token == Token::StartObject || _token == Token::StartArray) {
+                ++depth;
+            }
+            else if (_token == Token::EndObject || _token == Token::EndArray) {
+                --depth;
+            }
+        }
+    }
+
+    Token token() const { return _token; }
+
+    bool hasError() const { return _reader.HasParseError(); }
+
+    int errorCode() const { return (int)_reader.GetParseErrorCode(); }
+
+    bool boolValue() const { return _bool; }
+
+    int64_t int64Value() const { return _int64; }
+
+    uint64_t uint64Value() const { return _uint64; }
+
+    double doubleValue() const { return _double; }
+
+    const std::string& stringValue() const { return _string; }
+
+    // SAX handler interface, invoked by the reader
+    bool Null() { _token = Token::Null; return true; }
+    bool Bool(bool b) { _token = Token::Bool; _bool = b; return true; }
+    bool Int(int i) { _token = Token::Int; _int64 = i; _uint64 = (uint64_t)i; _double = i; return true; }
+    bool Uint(unsigned u) { _token = Token::Uint; _int64 = u; _uint64 = u; _double = u; return true; }
+    bool Int64(int64_t i) { _token = Token::Int64; _int64 = i; _uint64 = (uint64_t)i; _double = (double)i; return true; }
+    bool Uint64(uint64_t u) { _token = Token::Uint64; _int64 = (int64_t)u; _uint64 = u; _double = (double)u; return true; }
+    bool Double(double d) { _token = Token::Double; _double = d; return true; }
+    bool RawNumber(const char* str, SizeType length, bool) { _token = Token::String; _string.assign(str, length); return true; }
+    bool String(const char* str, SizeType length, bool) { _token = Token::String; _string.assign(str, length); return true; }
+    bool Key(const char* str, SizeType length, bool) { _token = Token::Key; _string.assign(str, length); return true; }
+    bool StartObject() { _token = Token::StartObject; return true; }
+    bool EndObject(SizeType) { _token = Token::EndObject; return true; }
+    bool StartArray() { _token = Token::StartArray; return true; }
+    bool EndArray(SizeType) { _token = Token::EndArray; return true; }
+
+private:
+    JsonArenaScope _scope;
+    MemoryStream _stream;
+    GenericReader<UTF8<>, UTF8<>, MemoryPoolAllocator<>> _reader;
+    Token _token = Token::None;
+    bool _bool = false;
+    int64_t _int64 = 0;
+    uint64_t _uint64 = 0;
+    double _double = 0.0;
+    std::string _string;
+};
+
+template<typename Reader>
+inline void json_stream_expect_next(Reader& reader, const std::string& name) {
+    if (!reader.next()) {
+        throw JsonStreamTypeMismatch(name);
+    }
+}
+
+//the functor for a single type, primary template handles FIELDS_MAP models.
+//write() accepts any rapidjson Writer-like handler, read() any reader exposing the JsonPullReader interface
+template<typename Type, typename Enable = void>
+struct JsonStreamCodec {
+    template<typename Writer>
+    static void write(Writer& writer, const Type& value) {
+        value.jwrite(writer);
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, Type& value) {
+        if (reader.token() != JsonToken::StartObject) {
+            throw JsonStreamTypeMismatch(name);
+        }
+        while (true) {
+            json_stream_expect_next(reader, name);
+            if (reader.token() == JsonToken::EndObject) {
+                break;
+            }
+            std::string key = reader.stringValue();
+            json_stream_expect_next(reader, key);
+            if (!value.jread_field(reader, key)) {
+                reader.skip();
+            }
+        }
+    }
+};
+
+template<>
+struct JsonStreamCodec<bool> {
+    template<typename Writer>
+    static void write(Writer& writer, bool value) {
+        writer.Bool(value);
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, bool& value) {
+        if (reader.token() != JsonToken::Bool) {
+            throw JsonStreamTypeMismatch(name);
+        }
+        value = reader.boolValue();
+    }
+};
+
+template<typename Type>
+struct JsonStreamCodec<Type, typename std::enable_if<std::is_integral<Type>::value && !std::is_same<Type, bool>::value>::type> {
+    template<typename Writer>
+    static void write(Writer& writer, Type value) {
+        if (std::is_signed<Type>::value) {
+            if (sizeof(Type) <= sizeof(int)) {
+                writer.Int((int)value);
+            }
+            else {
+                writer.Int64((int64_t)value);
+            }
+        }
+        else {
+            if (sizeof(Type) <= sizeof(unsigned)) {
+                writer.Uint((unsigned)value);
+            }
+            else {
+                writer.Uint64((uint64_t)value);
+            }
+        }
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, Type& value) {
+        using Token = JsonToken;
+        auto token = reader.token();
+        if (token == Token::Int || token == Token::Int64) {
+            int64_t v = reader.int64Value();
+            if ((std::is_unsigned<Type>::value && v < 0) ||
+                v < (int64_t)std::numeric_limits<Type>::min() ||
+                (std::is_signed<Type>::value && v > (int64_t)std::numeric_limits<Type>::max())) {
+                throw JsonStreamTypeMismatch(name);
+            }
+            value = (Type)v;
+        }
+        else if (token == Token::Uint || token == Token::Uint64) {
+            uint64_t v = reader.uint64Value();
+            if (v > (uint64_t)std::numeric_limits<Type>::max()) {
+                throw JsonStreamTypeMismatch(name);
+            }
+            value = (Type)v;
+        }
+        else {
+            throw JsonStreamTypeMismatch(name);
+        }
+    }
+};
+
+template<typename Type>
+struct JsonStreamCodec<Type, typename std::enable_if<std::is_floating_point<Type>::value>::type> {
+    template<typename Writer>
+    static void write(Writer& writer, Type value) {
+        writer.Double((double)value);
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, Type& value) {
+        using Token = JsonToken;
+        auto token = reader.token();
+        if (token != Token::Double && token != Token::Int && token != Token::Uint && token != Token::Int64 && token != Token::Uint64) {
+            throw JsonStreamTypeMismatch(name);
+        }
+        value = (Type)reader.doubleValue();
+    }
+};
+
+template<>
+struct JsonStreamCodec<std::string> {
+    template<typename Writer>
+    static void write(Writer& writer, const std::string& value) {
+        writer.String(value.data(), (SizeType)value.size());
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, std::string& value) {
+        if (reader.token() != JsonToken::String) {
+            throw JsonStreamTypeMismatch(name);
+        }
+        value = reader.stringValue();
+    }
+};
+
+//null leaves the optional untouched, the same as json_deserialize
+template<typename Type>
+struct JsonStreamCodec<absl::optional<Type>> {
+    template<typename Writer>
+    static void write(Writer& writer, const absl::optional<Type>& value) {
+        if (value) {
+            JsonStreamCodec<Type>::write(writer, *value);
+        }
+        else {
+            writer.Null();
+        }
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, absl::optional<Type>& value) {
+        if (reader.token() == JsonToken::Null) {
+            return;
+        }
+        Type v;
+        JsonStreamCodec<Type>::read(reader, name, v);
+        value = std::move(v);
+    }
+};
+
+template<typename Type>
+struct JsonStreamCodec<std::vector<Type>> {
+    template<typename Writer>
+    static void write(Writer& writer, const std::vector<Type>& value) {
+        writer.StartArray();
+        for (const auto& item : value) {
+            JsonStreamCodec<Type>::write(writer, item);
+        }
+        writer.EndArray();
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, std::vector<Type>& value) {
+        if (reader.token() != JsonToken::StartArray) {
+            throw JsonStreamTypeMismatch(name);
+        }
+        value.clear();
+        while (true) {
+            json_stream_expect_next(reader, name);
+            if (reader.token() == JsonToken::EndArray) {
+                break;
+            }
+            Type v;
+            JsonStreamCodec<Type>::read(reader, name, v);
+            value.emplace_back(std::move(v));
+        }
+    }
+};
+
+template<typename Type>
+struct JsonStreamCodec<std::map<std::string, Type>> {
+    template<typename Writer>
+    static void write(Writer& writer, const std::map<std::string, Type>& value) {
+        writer.StartObject();
+        for (const auto& pair : value) {
+            writer.Key(pair.first.data(), (SizeType)pair.first.size());
+            JsonStreamCodec<Type>::write(writer, pair.second);
+        }
+        writer.EndObject();
+    }
+
+    template<typename Reader>
+    static void read(Reader& reader, const std::string& name, std::map<std::string, Type>& value) {
+        if (reader.token() != JsonToken::StartObject) {
+            throw JsonStreamTypeMismatch(name);
+        }
+        value.clear();
+        while (true) {
+            json_stream_expect_next(reader, name);
+            if (reader.token() == JsonToken::EndObject) {
+                break;
+            }
+            std::string key = reader.stringValue();
+            json_stream_expect_next(reader, key);
+            JsonStreamCodec<Type>::read(reader, key, value[key]);
+        }
+    }
+};
+
+//keys are string literals in FIELDS_MAP, their length is known at compile time
+template<size_t N>
+inline bool json_stream_key_equals(const std::string& key, const char (&name)[N]) {
+    return key.size() == N - 1 && std::memcmp(key.data(), name, N - 1) == 0;
+}
+
+inline bool json_stream_key_equals(const std::string& key, const std::string& name) {
+    return key == name;
+}
+
+template<typename Writer, size_t N>
+inline void json_stream_write_key(Writer& writer, const char (&name)[N]) {
+    writer.Key(name, (SizeType)(N - 1));
+}
+
+template<typename Writer>
+inline void json_stream_write_key(Writer& writer, const std::string& name) {
+    writer.Key(name.data(), (SizeType)name.size());
+}
+
+template<typename Type>
+struct json_stream_is_optional {
+    static const bool value = false;
+};
+
+template<typename Type>
+struct json_stream_is_optional<absl::optional<Type>> {
+    static const bool value = true;
+};
+
+//absent optionals are omitted, the same as json_serialize
+template<typename Writer, typename Key, typename Type>
+inline void json_stream_write_field(Writer& writer, const Key& name, const Type& value, std::true_type) {
+    if (value) {
+        json_stream_write_key(writer, name);
+        JsonStreamCodec<typename Type::value_type>::write(writer, *value);
+    }
+}
+
+template<typename Writer, typename Key, typename Type>
+inline void json_stream_write_field(Writer& writer, const Key& name, const Type& value, std::false_type) {
+    json_stream_write_key(writer, name);
+    JsonStreamCodec<Type>::write(writer, value);
+}
+
+template<typename Writer, typename Key, typename Type, typename... Tail>
+inline void json_stream_write(Writer& writer, const Key& name, const Type& value, const Tail& ... tail) {
+    json_stream_write_field(writer, name, value, std::integral_constant<bool, json_stream_is_optional<Type>::value>());
+    json_stream_write(writer, tail...);
+}
+
+//terminus
+template<typename Writer>
+inline void json_stream_write(Writer& writer) {
+}
+
+template<typename Reader, typename Key, typename Type, typename... Tail>
+inline bool json_stream_read_field(Reader& reader, const std::string& key, const Key& name, Type& value, Tail& ... tail) {
+    if (json_stream_key_equals(key, name)) {
+        JsonStreamCodec<Type>::read(reader, key, value);
+        return true;
+    }
+    return json_stream_read_field(reader, key, tail...);
+}
+
+//terminus
+template<typename Reader>
+inline bool json_stream_read_field(Reader& reader, const std::string& key) {
+    return false;
+}
+}
+
+//declares the streaming encoder and decoder of a model
+#define JSON_STREAM_ENCODE(...)\
+    template<typename Writer>\
+    void jwrite(Writer& writer) const\
+    {\
+        writer.StartObject();\
+        rapidjson::json_stream_write(writer, __VA_ARGS__);\
+        writer.EndObject();\
+    }
+
+#define JSON_STREAM(...)\
+    JSON_STREAM_ENCODE(__VA_ARGS__)\
+    template<typename Reader>\
+    bool jread_field(Reader& reader, const std::string& key)\
+    {\
+        return rapidjson::json_stream_read_field(reader, key, __VA_ARGS__);\
+    }
+
+//the output buffer is reused per thread, only the returned string is allocated
+template<typename Type>
+inline std::string toJsonStream(const Type& value) {
+    thread_local rapidjson::StringBuffer buffer;
+    buffer.Clear();
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    rapidjson::JsonStreamCodec<Type>::write(writer, value);
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+template<typename Type>
+inline std::shared_ptr<Type> fromJsonStream(absl::string_view data, std::string& error) {
+    std::shared_ptr<Type> object = std::make_shared<Type>();
+    rapidjson::JsonPullReader reader(data.data(), data.size());
+    try {
+        if (!reader.next()) {
+            throw JsonStreamTypeMismatch("document");
+        }
+        rapidjson::JsonStreamCodec<Type>::read(reader, "document", *object);
+    }
+    catch (const JsonStreamTypeMismatch& e) {
+        error = e.what();
+    }
+    // A truncated or malformed document surfaces as a mismatch above, report the real cause
+    if (reader.hasError()) {
+        error = "JsonParsingFailed, code: " + std::to_string(reader.errorCode());
+    }
+    return object;
+}
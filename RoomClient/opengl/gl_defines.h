@@ -15,10 +15,18 @@
 #include <OpenGL/gl3.h>
 #elif WIN32
 #include <GL/glew.h>
+#elif defined(__linux__)
+// Core profile entry points exported by libGL / libOpenGL, as Mesa does for EGL and OSMesa contexts
+#define GL_GLEXT_PROTOTYPES 1
+#include <GL/glcorearb.h>
 #endif
+#if !defined(__linux__)
 #include <OpenGL/gl3.h>
+#endif
 #if TARGET_OS_IPHONE
 #define RTC_PIXEL_FORMAT GL_LUMINANCE
+#define RTC_UV_PIXEL_FORMAT GL_LUMINANCE_ALPHA
+#define NV12_UV_SWIZZLE "ra"
 #define SHADER_VERSION
 #define VERTEX_SHADER_IN "attribute"
 #define VERTEX_SHADER_OUT "varying"
@@ -31,6 +39,10 @@
 typedef EAGLContext GlContextType;
 #else
 #define RTC_PIXEL_FORMAT GL_RED
+#define RTC_UV_PIXEL_FORMAT GL_RG
+#define NV12_UV_SWIZZLE "rg"
+// Normalized 16 bit single channel textures for 10 bit planes
+#define RTC_HAS_16BIT_TEXTURES 1
 #define SHADER_VERSION "#version 150\n"
 #define VERTEX_SHADER_IN "in"
 #define VERTEX_SHADER_OUT "out"
@@ -38,6 +50,14 @@ typedef EAGLContext GlContextType;
 #define FRAGMENT_SHADER_OUT "out vec4 fragColor;\n"
 #define FRAGMENT_SHADER_COLOR "fragColor"
 #define FRAGMENT_SHADER_TEXTURE "texture"
+// Immutable texture storage and persistent mapped buffers, GL 4.4 or the ARB extensions
+#if defined(GL_VERSION_4_4) || (defined(GL_ARB_buffer_storage) && defined(GL_ARB_texture_storage))
+#define RTC_HAS_BUFFER_STORAGE 1
+#endif
+// Retrievable program binaries, GL 4.1 or the ARB extension
+#if defined(GL_VERSION_4_1) || defined(GL_ARB_get_program_binary)
+#define RTC_HAS_PROGRAM_BINARY 1
+#endif
 //@class EAGLContext;
 //typedef EAGLContext GlContextType;
 #endif
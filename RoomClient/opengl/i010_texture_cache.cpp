@@ -0,0 +1,84 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "i010_texture_cache.h"
+
+I010TextureCache::I010TextureCache()
+{
+
+}
+
+I010TextureCache::~I010TextureCache()
+{
+    glDeleteTextures(kNumTextures, _textures);
+}
+
+void I010TextureCache::init()
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    setupTextures();
+}
+
+GLuint I010TextureCache::yTexture()
+{
+    return _textures[_currentTextureSet * kNumTexturesPerSet];
+}
+
+GLuint I010TextureCache::uTexture()
+{
+    return _textures[_currentTextureSet * kNumTexturesPerSet + 1];
+}
+
+GLuint I010TextureCache::vTexture()
+{
+    return _textures[_currentTextureSet * kNumTexturesPerSet + 2];
+}
+
+void I010TextureCache::setupTextures()
+{
+    glGenTextures(kNumTextures, _textures);
+    for (GLsizei i = 0; i < kNumTextures; i++) {
+        glBindTexture(GL_TEXTURE_2D, _textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+}
+
+void I010TextureCache::uploadPlane(const uint16_t* plane, GLuint texture, int width, int height, int32_t stride)
+{
+#if RTC_HAS_16BIT_TEXTURES
+    // Strides of I010 buffers are in samples, which is what GL_UNPACK_ROW_LENGTH expects
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+    glTexImage2D(GL_TEXTURE_2D,
+        0,
+        GL_R16,
+        width,
+        height,
+        0,
+        GL_RED,
+        GL_UNSIGNED_SHORT,
+        plane);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+}
+
+void I010TextureCache::uploadFrameToTextures(const webrtc::I010BufferInterface& buffer)
+{
+    _currentTextureSet = (_currentTextureSet + 1) % kNumTextureSets;
+
+    uploadPlane(buffer.DataY(), yTexture(), buffer.width(), buffer.height(), buffer.StrideY());
+
+    uploadPlane(buffer.DataU(), uTexture(), buffer.ChromaWidth(), buffer.ChromaHeight(), buffer.StrideU());
+
+    uploadPlane(buffer.DataV(), vTexture(), buffer.ChromaWidth(), buffer.ChromaHeight(), buffer.StrideV());
+}
@@ -0,0 +1,53 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include "gl_defines.h"
+#include <memory>
+#include <stdint.h>
+#include "api/video/video_frame_buffer.h"
+
+// Uploads 10 bit I010 frames into three 16 bit single channel textures, sampled by the I010
+// shader which rescales the samples. Avoids narrowing to 8 bit on the CPU.
+class I010TextureCache
+    : public std::enable_shared_from_this<I010TextureCache>
+{
+public:
+    static const GLsizei kNumTextureSets = 2;
+
+    static const GLsizei kNumTexturesPerSet = 3;
+
+    static const GLsizei kNumTextures = kNumTexturesPerSet * kNumTextureSets;
+
+    I010TextureCache();
+
+    ~I010TextureCache();
+
+public:
+    void init();
+
+    void uploadFrameToTextures(const webrtc::I010BufferInterface& buffer);
+
+    GLuint yTexture();
+
+    GLuint uTexture();
+
+    GLuint vTexture();
+
+protected:
+    void setupTextures();
+
+    void uploadPlane(const uint16_t* plane, GLuint texture, int width, int height, int32_t stride);
+
+private:
+    GLint _currentTextureSet = 0;
+
+    GLuint _textures[kNumTextures];
+};
@@ -9,6 +9,10 @@
 
 #include "i420_texture_cache.h"
 #include "gl_defines.h"
+#include "texture_pool.h"
+#include "plane_repacker.h"
+#include <string.h>
+#include "logger/spd_logger.h"
 
 I420TextureCache::I420TextureCache()
 {
@@ -17,14 +21,125 @@ I420TextureCache::I420TextureCache()
 
 I420TextureCache::~I420TextureCache()
 {
-    glDeleteTextures(kNumTextures, _textures);
+    releaseStorage();
+    if (_mode == UploadMode::Direct) {
+        glDeleteTextures(kNumTextures, _textures);
+    }
 }
 
-void I420TextureCache::init()
+void I420TextureCache::init(UploadMode mode, std::shared_ptr<TexturePool> texturePool)
 {
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    setupTextures();
+#if TARGET_OS_IPHONE
+    _hasUnpackRowLength = false;
+#else
+    _hasUnpackRowLength = true;
+#endif
+
+    _mode = mode;
+    if (_mode == UploadMode::Streaming && !isStreamingSupported()) {
+        DLOG("buffer storage is not supported, fall back to direct texture upload");
+        _mode = UploadMode::Direct;
+    }
+
+    if (_mode == UploadMode::Streaming) {
+        // Textures are acquired per resolution on the first frame
+        memset(_textures, 0, sizeof(_textures));
+        _texturePool = texturePool ? texturePool : TexturePool::forShareGroup(nullptr);
+    }
+    else {
+        setupTextures();
+    }
+}
+
+void I420TextureCache::recycle()
+{
+    if (_mode == UploadMode::Streaming) {
+        releaseStorage();
+    }
+}
+
+I420TextureCache::UploadMode I420TextureCache::uploadMode() const
+{
+    return _mode;
+}
+
+bool I420TextureCache::isStreamingSupported()
+{
+#if RTC_HAS_BUFFER_STORAGE
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    return major > 4 || (major == 4 && minor >= 4);
+#else
+    return false;
+#endif
+}
+
+void I420TextureCache::allocateStorage(int width, int height)
+{
+#if RTC_HAS_BUFFER_STORAGE
+    releaseStorage();
+
+    // Immutable storage cannot be respecified, a new resolution takes texture objects of that size
+    // from the pool and gives the old ones back
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    for (GLsizei i = 0; i < kNumTextures; i++) {
+        const bool isLuma = i % kNumTexturesPerSet == 0;
+        _textures[i] = _texturePool->acquire(GL_R8, isLuma ? width : chromaWidth, isLuma ? height : chromaHeight);
+    }
+
+    _pixelBufferSize = (size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(kNumPixelBuffers, _pixelBuffers);
+    for (GLsizei i = 0; i < kNumPixelBuffers; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[i]);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, _pixelBufferSize, nullptr, flags);
+        _mappedPixelBuffers[i] = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, _pixelBufferSize, flags));
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    _storageWidth = width;
+    _storageHeight = height;
+    _currentPixelBuffer = 0;
+#endif
+}
+
+void I420TextureCache::releaseStorage()
+{
+#if RTC_HAS_BUFFER_STORAGE
+    for (GLsizei i = 0; i < kNumPixelBuffers; i++) {
+        if (_pixelBufferFences[i]) {
+            glDeleteSync(_pixelBufferFences[i]);
+            _pixelBufferFences[i] = nullptr;
+        }
+        if (_mappedPixelBuffers[i]) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            _mappedPixelBuffers[i] = nullptr;
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (_pixelBuffers[0]) {
+        glDeleteBuffers(kNumPixelBuffers, _pixelBuffers);
+        memset(_pixelBuffers, 0, sizeof(_pixelBuffers));
+    }
+    if (_texturePool) {
+        for (GLsizei i = 0; i < kNumTextures; i++) {
+            if (_textures[i]) {
+                _texturePool->release(_textures[i]);
+                _textures[i] = 0;
+            }
+        }
+    }
+    _storageWidth = 0;
+    _storageHeight = 0;
+    _pixelBufferSize = 0;
+#endif
 }
 
 GLuint I420TextureCache::yTexture()
@@ -59,34 +174,10 @@ void I420TextureCache::uploadPlane(const uint8_t* plane, GLuint texture, size_t
 {
     glBindTexture(GL_TEXTURE_2D, texture);
 
-    const uint8_t *uploadPlane = plane;
-
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
-    if ((size_t)stride != width) {
-        if (_hasUnpackRowLength) {
-            // GLES3 allows us to specify stride.
-            glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
-            glTexImage2D(GL_TEXTURE_2D,
-                0,
-                RTC_PIXEL_FORMAT,
-                static_cast<GLsizei>(width),
-                static_cast<GLsizei>(height),
-                0,
-                RTC_PIXEL_FORMAT,
-                GL_UNSIGNED_BYTE,
-                uploadPlane);
-            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-            return;
-        }
-        else {
-            // Make an unpadded copy and upload that instead. Quick profiling showed
-            // that this is faster than uploading row by row using glTexSubImage2D.
-            uint8_t *unpaddedPlane = _planeBuffer.data();
-            for (size_t y = 0; y < height; ++y) {
-                memcpy(unpaddedPlane + y * width, plane + y * stride, width);
-            }
-            uploadPlane = unpaddedPlane;
-        }
+    // Only called with padded planes when the row length can be given to GL
+    const bool padded = (size_t)stride != width;
+    if (padded) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
     }
     glTexImage2D(GL_TEXTURE_2D,
         0,
@@ -96,26 +187,58 @@ void I420TextureCache::uploadPlane(const uint8_t* plane, GLuint texture, size_t
         0,
         RTC_PIXEL_FORMAT,
         GL_UNSIGNED_BYTE,
-        uploadPlane);
+        plane);
+    if (padded) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
 }
 
 void I420TextureCache::uploadFrameToTextures(const webrtc::VideoFrame& frame)
+{
+    uploadBufferToTextures(frame.video_frame_buffer());
+}
+
+void I420TextureCache::uploadBufferToTextures(const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& vfb)
 {
     _currentTextureSet = (_currentTextureSet + 1) % kNumTextureSets;
 
-    rtc::scoped_refptr<webrtc::VideoFrameBuffer> vfb = frame.video_frame_buffer();
     if (!vfb) {
         return;
     }
 
     rtc::scoped_refptr<webrtc::I420BufferInterface> buffer = vfb->ToI420();
 
+    if (_mode == UploadMode::Streaming) {
+        streamFrameToTextures(*buffer);
+        return;
+    }
+
     const int chromaWidth = buffer->ChromaWidth();
     const int chromaHeight = buffer->ChromaHeight();
-    if (buffer->StrideY() != frame.width() ||
+    const bool padded = buffer->StrideY() != buffer->width() ||
         buffer->StrideU() != chromaWidth ||
-        buffer->StrideV() != chromaWidth) {
-        _planeBuffer.resize(buffer->width() * buffer->height());
+        buffer->StrideV() != chromaWidth;
+
+    if (padded && !_hasUnpackRowLength) {
+        // Make an unpadded copy of all three planes into one staging buffer and upload that instead. Quick
+        // profiling showed that this is faster than uploading row by row using glTexSubImage2D.
+        const size_t lumaSize = (size_t)buffer->width() * buffer->height();
+        const size_t chromaSize = (size_t)chromaWidth * chromaHeight;
+        uint8_t* staging = _stagingBuffer.reserve(lumaSize + 2 * chromaSize);
+        if (!staging) {
+            DLOG("failed to allocate the staging buffer");
+            return;
+        }
+        PlaneRepacker::copyI420(staging,
+            buffer->DataY(), buffer->StrideY(),
+            buffer->DataU(), buffer->StrideU(),
+            buffer->DataV(), buffer->StrideV(),
+            buffer->width(), buffer->height());
+
+        uploadPlane(staging, yTexture(), buffer->width(), buffer->height(), buffer->width());
+        uploadPlane(staging + lumaSize, uTexture(), chromaWidth, chromaHeight, chromaWidth);
+        uploadPlane(staging + lumaSize + chromaSize, vTexture(), chromaWidth, chromaHeight, chromaWidth);
+        return;
     }
 
     uploadPlane(buffer->DataY(), yTexture(), buffer->width(), buffer->height(),  buffer->StrideY());
@@ -124,3 +247,59 @@ void I420TextureCache::uploadFrameToTextures(const webrtc::VideoFrame& frame)
 
     uploadPlane(buffer->DataV(), vTexture(), buffer->ChromaWidth(), buffer->ChromaHeight(), buffer->StrideV());
 }
+
+void I420TextureCache::streamFrameToTextures(const webrtc::I420BufferInterface& buffer)
+{
+#if RTC_HAS_BUFFER_STORAGE
+    if (buffer.width() != _storageWidth || buffer.height() != _storageHeight) {
+        allocateStorage(buffer.width(), buffer.height());
+    }
+
+    const GLint slot = _currentPixelBuffer;
+    _currentPixelBuffer = (_currentPixelBuffer + 1) % kNumPixelBuffers;
+
+    uint8_t* staging = _mappedPixelBuffers[slot];
+    if (!staging) {
+        DLOG("pixel buffer is not mapped");
+        return;
+    }
+
+    // The ring is deep enough that this fence has normally signalled long ago, waiting here only
+    // throttles the CPU when the GPU falls behind by a whole ring.
+    if (_pixelBufferFences[slot]) {
+        glClientWaitSync(_pixelBufferFences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(_pixelBufferFences[slot]);
+        _pixelBufferFences[slot] = nullptr;
+    }
+
+    const size_t width = buffer.width();
+    const size_t height = buffer.height();
+    const size_t chromaWidth = buffer.ChromaWidth();
+    const size_t chromaHeight = buffer.ChromaHeight();
+    const size_t uOffset = width * height;
+    const size_t vOffset = uOffset + chromaWidth * chromaHeight;
+
+    PlaneRepacker::copyI420(staging,
+        buffer.DataY(), buffer.StrideY(),
+        buffer.DataU(), buffer.StrideU(),
+        buffer.DataV(), buffer.StrideV(),
+        width, height);
+
+    // Data pointers are offsets into the bound unpack buffer, the transfer runs asynchronously
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[slot]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    glBindTexture(GL_TEXTURE_2D, yTexture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)width, (GLsizei)height, RTC_PIXEL_FORMAT, GL_UNSIGNED_BYTE, (const void*)0);
+
+    glBindTexture(GL_TEXTURE_2D, uTexture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)chromaWidth, (GLsizei)chromaHeight, RTC_PIXEL_FORMAT, GL_UNSIGNED_BYTE, (const void*)uOffset);
+
+    glBindTexture(GL_TEXTURE_2D, vTexture());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)chromaWidth, (GLsizei)chromaHeight, RTC_PIXEL_FORMAT, GL_UNSIGNED_BYTE, (const void*)vOffset);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    _pixelBufferFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
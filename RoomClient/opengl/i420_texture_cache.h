@@ -12,6 +12,7 @@
 #include "gl_defines.h"
 #include <memory>
 #include <vector>
+#include "plane_repacker.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
 #include <stdint.h>
@@ -23,38 +24,83 @@ static const GLsizei kNumTextureSets = 2;
 static const GLsizei kNumTexturesPerSet = 3;
 static const GLsizei kNumTextures = kNumTexturesPerSet * kNumTextureSets;
 
+// Pixel buffers written by the CPU while the GPU still reads from the previous ones.
+static const GLsizei kNumPixelBuffers = 3;
+
+class TexturePool;
+
 class I420TextureCache
     : public std::enable_shared_from_this<I420TextureCache>
 {
 public:
+    enum class UploadMode {
+        // glTexImage2D straight from the frame, storage is respecified on every upload
+        Direct,
+        // Immutable storage allocated once per resolution, planes staged through a ring of
+        // persistent mapped pixel buffers so the copy overlaps the GPU reading the previous frame
+        Streaming
+    };
+
     I420TextureCache();
 
     ~I420TextureCache();
 
 public:
-    void init();
+    // Falls back to Direct when the context has no buffer storage support. Streaming textures come
+    // from |texturePool|, nullptr gives the cache a pool of its own
+    void init(UploadMode mode = UploadMode::Direct, std::shared_ptr<TexturePool> texturePool = nullptr);
+
+    UploadMode uploadMode() const;
 
     void uploadFrameToTextures(const webrtc::VideoFrame& frame);
 
+    // Buffers that are not I420 are converted with ToI420()
+    void uploadBufferToTextures(const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& vfb);
+
     GLuint yTexture();
 
     GLuint uTexture();
 
     GLuint vTexture();
 
+    // Hands the streaming textures back to the pool, the next upload acquires new ones
+    void recycle();
+
 protected:
     void setupTextures();
 
     void uploadPlane(const uint8_t* plane, GLuint texture, size_t width, size_t height, int32_t stride);
 
+    static bool isStreamingSupported();
+
+    void allocateStorage(int width, int height);
+
+    void releaseStorage();
+
+    void streamFrameToTextures(const webrtc::I420BufferInterface& buffer);
+
 private:
-    bool _hasUnpackRowLength;
+    UploadMode _mode = UploadMode::Direct;
+
+    // GL_UNPACK_ROW_LENGTH lets padded planes be uploaded in place
+    bool _hasUnpackRowLength = false;
     GLint _currentTextureSet = 0;
 
     // Handles for OpenGL constructs.
-    GLuint _textures[kNumTextures];
-
-    // Used to create a non-padded plane for GPU upload when we receive padded frames.
-    std::vector<uint8_t> _planeBuffer;
+    GLuint _textures[kNumTextures] = {};
+
+    // Holds the three planes packed back to back when padded frames cannot be uploaded in place,
+    // kept across frames and only grown
+    AlignedStagingBuffer _stagingBuffer;
+
+    // Streaming mode state, sized for the current resolution
+    std::shared_ptr<TexturePool> _texturePool;
+    int _storageWidth = 0;
+    int _storageHeight = 0;
+    size_t _pixelBufferSize = 0;
+    GLint _currentPixelBuffer = 0;
+    GLuint _pixelBuffers[kNumPixelBuffers] = {};
+    uint8_t* _mappedPixelBuffers[kNumPixelBuffers] = {};
+    GLsync _pixelBufferFences[kNumPixelBuffers] = {};
 };
 
@@ -0,0 +1,81 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "nv12_texture_cache.h"
+
+NV12TextureCache::NV12TextureCache()
+{
+
+}
+
+NV12TextureCache::~NV12TextureCache()
+{
+    glDeleteTextures(kNumTextures, _textures);
+}
+
+void NV12TextureCache::init()
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    setupTextures();
+}
+
+GLuint NV12TextureCache::yTexture()
+{
+    return _textures[_currentTextureSet * kNumTexturesPerSet];
+}
+
+GLuint NV12TextureCache::uvTexture()
+{
+    return _textures[_currentTextureSet * kNumTexturesPerSet + 1];
+}
+
+void NV12TextureCache::setupTextures()
+{
+    glGenTextures(kNumTextures, _textures);
+    for (GLsizei i = 0; i < kNumTextures; i++) {
+        glBindTexture(GL_TEXTURE_2D, _textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+}
+
+void NV12TextureCache::uploadFrameToTextures(const webrtc::NV12BufferInterface& buffer)
+{
+    _currentTextureSet = (_currentTextureSet + 1) % kNumTextureSets;
+
+    // Row length is in pixels, a UV pixel is two bytes
+    glBindTexture(GL_TEXTURE_2D, yTexture());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer.StrideY());
+    glTexImage2D(GL_TEXTURE_2D,
+        0,
+        RTC_PIXEL_FORMAT,
+        buffer.width(),
+        buffer.height(),
+        0,
+        RTC_PIXEL_FORMAT,
+        GL_UNSIGNED_BYTE,
+        buffer.DataY());
+
+    glBindTexture(GL_TEXTURE_2D, uvTexture());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, buffer.StrideUV() / 2);
+    glTexImage2D(GL_TEXTURE_2D,
+        0,
+        RTC_UV_PIXEL_FORMAT,
+        buffer.ChromaWidth(),
+        buffer.ChromaHeight(),
+        0,
+        RTC_UV_PIXEL_FORMAT,
+        GL_UNSIGNED_BYTE,
+        buffer.DataUV());
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
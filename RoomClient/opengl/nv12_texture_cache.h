@@ -0,0 +1,49 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include "gl_defines.h"
+#include <memory>
+#include <stdint.h>
+#include "api/video/nv12_buffer.h"
+
+// Uploads NV12 frames as they are: a single channel Y texture and a two channel interleaved UV
+// texture, sampled by the NV12 shader. Two sets are kept like I420TextureCache.
+class NV12TextureCache
+    : public std::enable_shared_from_this<NV12TextureCache>
+{
+public:
+    static const GLsizei kNumTextureSets = 2;
+
+    static const GLsizei kNumTexturesPerSet = 2;
+
+    static const GLsizei kNumTextures = kNumTexturesPerSet * kNumTextureSets;
+
+    NV12TextureCache();
+
+    ~NV12TextureCache();
+
+public:
+    void init();
+
+    void uploadFrameToTextures(const webrtc::NV12BufferInterface& buffer);
+
+    GLuint yTexture();
+
+    GLuint uvTexture();
+
+protected:
+    void setupTextures();
+
+private:
+    GLint _currentTextureSet = 0;
+
+    GLuint _textures[kNumTextures];
+};
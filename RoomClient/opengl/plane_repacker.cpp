@@ -0,0 +1,72 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "plane_repacker.h"
+#include <stdlib.h>
+#include <string.h>
+
+void PlaneRepacker::copyPlane(uint8_t* dst, const uint8_t* src, size_t width, size_t height, int32_t stride)
+{
+    if ((size_t)stride == width) {
+        // Already packed, one contiguous copy
+        memcpy(dst, src, width * height);
+        return;
+    }
+    for (size_t y = 0; y < height; ++y) {
+        memcpy(dst + y * width, src + y * stride, width);
+    }
+}
+
+void PlaneRepacker::copyI420(uint8_t* dst,
+    const uint8_t* srcY, int32_t strideY,
+    const uint8_t* srcU, int32_t strideU,
+    const uint8_t* srcV, int32_t strideV,
+    size_t width, size_t height)
+{
+    const size_t chromaWidth = (width + 1) / 2;
+    const size_t chromaHeight = (height + 1) / 2;
+
+    copyPlane(dst, srcY, width, height, strideY);
+    dst += width * height;
+    copyPlane(dst, srcU, chromaWidth, chromaHeight, strideU);
+    dst += chromaWidth * chromaHeight;
+    copyPlane(dst, srcV, chromaWidth, chromaHeight, strideV);
+}
+
+AlignedStagingBuffer::AlignedStagingBuffer()
+{
+
+}
+
+AlignedStagingBuffer::~AlignedStagingBuffer()
+{
+#ifdef _MSC_VER
+    _aligned_free(_data);
+#else
+    free(_data);
+#endif
+}
+
+uint8_t* AlignedStagingBuffer::reserve(size_t size)
+{
+    if (size <= _capacity) {
+        return _data;
+    }
+
+#ifdef _MSC_VER
+    _aligned_free(_data);
+    _data = static_cast<uint8_t*>(_aligned_malloc(size, kAlignment));
+#else
+    free(_data);
+    void* data = nullptr;
+    _data = posix_memalign(&data, kAlignment, size) == 0 ? static_cast<uint8_t*>(data) : nullptr;
+#endif
+    _capacity = _data ? size : 0;
+    return _data;
+}
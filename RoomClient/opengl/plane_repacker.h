@@ -0,0 +1,57 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Copies padded planes into tightly packed rows. Rows are copied with memcpy, which the C runtime
+// already vectorizes, and planes whose stride equals their width go in one contiguous copy.
+class PlaneRepacker
+{
+public:
+    // Packs |height| rows of |width| bytes, |stride| bytes apart in |src|, into |dst|
+    static void copyPlane(uint8_t* dst, const uint8_t* src, size_t width, size_t height, int32_t stride);
+
+    // Packs Y, U and V back to back into |dst|, which holds width * height + 2 * chromaWidth * chromaHeight bytes
+    static void copyI420(uint8_t* dst,
+        const uint8_t* srcY, int32_t strideY,
+        const uint8_t* srcU, int32_t strideU,
+        const uint8_t* srcV, int32_t strideV,
+        size_t width, size_t height);
+};
+
+// Staging memory that keeps its allocation across frames, aligned for vector stores
+class AlignedStagingBuffer
+{
+public:
+    static const size_t kAlignment = 64;
+
+    AlignedStagingBuffer();
+
+    ~AlignedStagingBuffer();
+
+    // Grows the buffer when needed, the content is not preserved
+    uint8_t* reserve(size_t size);
+
+    uint8_t* data() const { return _data; }
+
+    size_t capacity() const { return _capacity; }
+
+private:
+    AlignedStagingBuffer(const AlignedStagingBuffer&) = delete;
+
+    AlignedStagingBuffer& operator=(const AlignedStagingBuffer&) = delete;
+
+private:
+    uint8_t* _data = nullptr;
+
+    size_t _capacity = 0;
+};
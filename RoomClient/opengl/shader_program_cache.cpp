@@ -0,0 +1,312 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "shader_program_cache.h"
+#include <stdio.h>
+#include <mutex>
+#include <vector>
+#include <sstream>
+#include "logger/spd_logger.h"
+
+namespace {
+    std::mutex& registryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // key: share group
+    std::unordered_map<const void*, std::weak_ptr<ShaderProgramCache>>& registry()
+    {
+        static std::unordered_map<const void*, std::weak_ptr<ShaderProgramCache>> caches;
+        return caches;
+    }
+
+    std::string& binaryDirectory()
+    {
+        static std::string directory;
+        return directory;
+    }
+
+    std::string glString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+std::shared_ptr<ShaderProgramCache> ShaderProgramCache::forShareGroup(const void* shareGroup)
+{
+    if (!shareGroup) {
+        return std::make_shared<ShaderProgramCache>();
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto& caches = registry();
+    auto cache = caches[shareGroup].lock();
+    if (!cache) {
+        cache = std::make_shared<ShaderProgramCache>();
+        caches[shareGroup] = cache;
+    }
+
+    // Share groups that went away leave expired entries behind
+    for (auto it = caches.begin(); it != caches.end();) {
+        if (it->second.expired()) {
+            it = caches.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    return cache;
+}
+
+void ShaderProgramCache::setBinaryDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(registryMutex());
+    binaryDirectory() = directory;
+}
+
+ShaderProgramCache::ShaderProgramCache()
+{
+
+}
+
+ShaderProgramCache::~ShaderProgramCache()
+{
+    for (const auto& pair : _programs) {
+        glDeleteProgram(pair.second);
+    }
+}
+
+GLuint ShaderProgramCache::program(const std::string& name,
+    const char* vertexSource,
+    const char* fragmentSource,
+    const std::function<bool(GLuint)>& setup)
+{
+    auto it = _programs.find(name);
+    if (it != _programs.end()) {
+        return it->second;
+    }
+
+    const std::string path = binaryPath(name, vertexSource, fragmentSource);
+
+    GLuint program = path.empty() ? 0 : loadProgramBinary(path);
+    const bool loaded = program != 0;
+    if (!loaded) {
+        program = createProgramFromSource(vertexSource, fragmentSource);
+    }
+    if (!program) {
+        return 0;
+    }
+
+    // Uniform values are not part of a program binary, setup runs on both paths
+    glUseProgram(program);
+    if (setup && !setup(program)) {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    if (!loaded && !path.empty()) {
+        saveProgramBinary(program, path);
+    }
+
+    _programs[name] = program;
+    return program;
+}
+
+// Compiles a shader of the given |type| with GLSL source |source| and returns
+// the shader handle or 0 on error.
+GLuint ShaderProgramCache::createShader(GLenum type, const GLchar *source) {
+    GLuint shader = glCreateShader(type);
+    if (!shader) {
+        return 0;
+    }
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint compileStatus = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+    if (compileStatus == GL_FALSE) {
+        GLint logLength = 0;
+        // The null termination character is included in the returned log length.
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+        if (logLength > 0) {
+            std::unique_ptr<char[]> compileLog(new char[logLength]);
+            // The returned string is null terminated.
+            glGetShaderInfoLog(shader, logLength, NULL, compileLog.get());
+            DLOG("Shader compile error: {}", compileLog.get());
+        }
+        glDeleteShader(shader);
+        shader = 0;
+    }
+    return shader;
+}
+
+// Links a shader program with the given vertex and fragment shaders and
+// returns the program handle or 0 on error.
+GLuint ShaderProgramCache::createProgram(GLuint vertexShader, GLuint fragmentShader) {
+    if (vertexShader == 0 || fragmentShader == 0) {
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    if (!program) {
+        return 0;
+    }
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindAttribLocation(program, kPositionAttribute, "position");
+    glBindAttribLocation(program, kTexcoordAttribute, "texcoord");
+#if RTC_HAS_PROGRAM_BINARY
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+    glLinkProgram(program);
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        glDeleteProgram(program);
+        program = 0;
+    }
+    return program;
+}
+
+GLuint ShaderProgramCache::createProgramFromSource(const char* vertexSource, const char* fragmentSource) {
+    GLuint vertexShader = createShader(GL_VERTEX_SHADER, vertexSource);
+    if (vertexShader == 0) {
+        DLOG("failed to create vertex shader");
+    }
+    GLuint fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (fragmentShader == 0) {
+        DLOG("failed to create fragment shader");
+    }
+    GLuint program = createProgram(vertexShader, fragmentShader);
+    // Shaders are created only to generate program.
+    if (vertexShader) {
+        glDeleteShader(vertexShader);
+    }
+    if (fragmentShader) {
+        glDeleteShader(fragmentShader);
+    }
+    return program;
+}
+
+std::string ShaderProgramCache::binaryPath(const std::string& name, const char* vertexSource, const char* fragmentSource)
+{
+#if RTC_HAS_PROGRAM_BINARY
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        directory = binaryDirectory();
+    }
+    if (directory.empty()) {
+        return "";
+    }
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        return "";
+    }
+
+    // Binaries are only valid for the driver that produced them
+    const std::string identity = glString(GL_VENDOR) + glString(GL_RENDERER) + glString(GL_VERSION) + vertexSource + fragmentSource;
+    std::stringstream sstr;
+    sstr << directory << "/" << name << "_" << std::hex << std::hash<std::string>()(identity) << ".bin";
+    return sstr.str();
+#else
+    return "";
+#endif
+}
+
+GLuint ShaderProgramCache::loadProgramBinary(const std::string& path)
+{
+#if RTC_HAS_PROGRAM_BINARY
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) {
+        return 0;
+    }
+
+    GLenum format = 0;
+    std::vector<uint8_t> binary;
+    if (fread(&format, sizeof(format), 1, fp) == 1 && fseek(fp, 0, SEEK_END) == 0) {
+        const long size = ftell(fp) - (long)sizeof(format);
+        if (size > 0 && fseek(fp, sizeof(format), SEEK_SET) == 0) {
+            binary.resize(size);
+            if (fread(binary.data(), 1, binary.size(), fp) != binary.size()) {
+                binary.clear();
+            }
+        }
+    }
+    fclose(fp);
+
+    if (binary.empty()) {
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    if (!program) {
+        return 0;
+    }
+    glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+
+    // Drivers reject binaries of another version, the program is then linked from source again
+    GLint linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        DLOG("stale program binary: {}", path);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+#else
+    return 0;
+#endif
+}
+
+void ShaderProgramCache::saveProgramBinary(GLuint program, const std::string& path)
+{
+#if RTC_HAS_PROGRAM_BINARY
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    GLenum format = 0;
+    std::vector<uint8_t> binary(length);
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0) {
+        return;
+    }
+
+    // Written next to the target and renamed into place, a crash or a second instance never leaves a torn binary behind
+    const std::string tempPath = path + ".tmp";
+    FILE* fp = fopen(tempPath.c_str(), "wb");
+    if (!fp) {
+        DLOG("failed to write program binary: {}", tempPath);
+        return;
+    }
+    bool written = fwrite(&format, sizeof(format), 1, fp) == 1;
+    written = fwrite(binary.data(), 1, length, fp) == (size_t)length && written;
+    written = fclose(fp) == 0 && written;
+    if (!written) {
+        DLOG("failed to write program binary: {}", tempPath);
+        remove(tempPath.c_str());
+        return;
+    }
+
+    // rename does not replace an existing file on Windows, a stale binary is removed first
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        remove(path.c_str());
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            DLOG("failed to rename program binary: {}", path);
+            remove(tempPath.c_str());
+        }
+    }
+#endif
+}
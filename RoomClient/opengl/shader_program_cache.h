@@ -0,0 +1,64 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include "gl_defines.h"
+#include <memory>
+#include <string>
+#include <functional>
+#include <unordered_map>
+
+// Attribute locations bound before linking, vertex arrays are set up without looking at a program
+static const GLuint kPositionAttribute = 0;
+static const GLuint kTexcoordAttribute = 1;
+
+// Linked programs shared by every context of one GL share group, each program is compiled once per
+// group. With a binary directory set, linked programs are also stored on disk and later runs load
+// them with glProgramBinary instead of compiling.
+class ShaderProgramCache
+    : public std::enable_shared_from_this<ShaderProgramCache>
+{
+public:
+    // Contexts created with the same |shareGroup| get the same cache, nullptr gets a private one
+    static std::shared_ptr<ShaderProgramCache> forShareGroup(const void* shareGroup);
+
+    // Empty disables the on-disk cache, which is the default
+    static void setBinaryDirectory(const std::string& directory);
+
+    ShaderProgramCache();
+
+    // Deletes the programs, a context of the share group must be current
+    ~ShaderProgramCache();
+
+    // Returns the program called |name|, linking it from the sources the first time. |setup| runs
+    // with the program in use after it was linked or loaded, returning false discards the program.
+    // Returns 0 on error.
+    GLuint program(const std::string& name,
+        const char* vertexSource,
+        const char* fragmentSource,
+        const std::function<bool(GLuint)>& setup);
+
+protected:
+    GLuint createShader(GLenum type, const GLchar* source);
+
+    GLuint createProgram(GLuint vertexShader, GLuint fragmentShader);
+
+    GLuint createProgramFromSource(const char* vertexSource, const char* fragmentSource);
+
+    GLuint loadProgramBinary(const std::string& path);
+
+    void saveProgramBinary(GLuint program, const std::string& path);
+
+    std::string binaryPath(const std::string& name, const char* vertexSource, const char* fragmentSource);
+
+private:
+    // key: program name
+    std::unordered_map<std::string, GLuint> _programs;
+};
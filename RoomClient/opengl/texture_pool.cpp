@@ -0,0 +1,138 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "texture_pool.h"
+#include <mutex>
+#include "logger/spd_logger.h"
+
+namespace {
+    std::mutex& registryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    // key: share group
+    std::unordered_map<const void*, std::weak_ptr<TexturePool>>& registry()
+    {
+        static std::unordered_map<const void*, std::weak_ptr<TexturePool>> pools;
+        return pools;
+    }
+}
+
+std::shared_ptr<TexturePool> TexturePool::forShareGroup(const void* shareGroup)
+{
+    if (!shareGroup) {
+        return std::make_shared<TexturePool>();
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto& pools = registry();
+    auto pool = pools[shareGroup].lock();
+    if (!pool) {
+        pool = std::make_shared<TexturePool>();
+        pools[shareGroup] = pool;
+    }
+
+    // Share groups that went away leave expired entries behind
+    for (auto it = pools.begin(); it != pools.end();) {
+        if (it->second.expired()) {
+            it = pools.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    return pool;
+}
+
+TexturePool::TexturePool()
+{
+
+}
+
+TexturePool::~TexturePool()
+{
+    for (auto& pair : _idleTextures) {
+        if (!pair.second.empty()) {
+            glDeleteTextures((GLsizei)pair.second.size(), pair.second.data());
+        }
+    }
+    if (!_usedTextures.empty()) {
+        DLOG("{} pooled textures are still in use", _usedTextures.size());
+    }
+}
+
+GLuint TexturePool::acquire(GLenum internalFormat, int width, int height)
+{
+    const Key key { internalFormat, width, height };
+
+    GLuint texture = 0;
+    auto it = _idleTextures.find(key);
+    if (it != _idleTextures.end() && !it->second.empty()) {
+        texture = it->second.back();
+        it->second.pop_back();
+        --_idleCount;
+    }
+    else {
+        texture = createTexture(internalFormat, width, height);
+        if (!texture) {
+            return 0;
+        }
+    }
+
+    _usedTextures[texture] = key;
+    return texture;
+}
+
+void TexturePool::release(GLuint texture)
+{
+    auto it = _usedTextures.find(texture);
+    if (it == _usedTextures.end()) {
+        DLOG("texture {} does not belong to the pool", texture);
+        return;
+    }
+    const Key key = it->second;
+    _usedTextures.erase(it);
+
+    if (_idleCount >= kMaxIdleTextures) {
+        glDeleteTextures(1, &texture);
+        return;
+    }
+    _idleTextures[key].push_back(texture);
+    ++_idleCount;
+}
+
+size_t TexturePool::idleTextures() const
+{
+    return _idleCount;
+}
+
+GLuint TexturePool::createTexture(GLenum internalFormat, int width, int height)
+{
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    if (!texture) {
+        return 0;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+#if RTC_HAS_BUFFER_STORAGE
+    glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+#else
+    // Without immutable storage only 8 bit formats are allocated
+    const GLenum format = internalFormat == GL_RG8 ? RTC_UV_PIXEL_FORMAT : RTC_PIXEL_FORMAT;
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+#endif
+    return texture;
+}
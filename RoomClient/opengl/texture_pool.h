@@ -0,0 +1,70 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include "gl_defines.h"
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+// Fixed size textures shared by every context of one GL share group. Textures given back by one
+// renderer are handed to the next one asking for the same format and size, so tiles that change
+// participants recycle their GPU memory instead of allocating new storage.
+class TexturePool
+    : public std::enable_shared_from_this<TexturePool>
+{
+public:
+    // Contexts created with the same |shareGroup| get the same pool, nullptr gets a private one
+    static std::shared_ptr<TexturePool> forShareGroup(const void* shareGroup);
+
+    TexturePool();
+
+    // Deletes idle textures, a context of the share group must be current
+    ~TexturePool();
+
+    // Returns a texture with storage of |internalFormat| and the given size, linear filtering and
+    // edge clamping, or 0 on error
+    GLuint acquire(GLenum internalFormat, int width, int height);
+
+    // Hands |texture| back, it must have been acquired from this pool
+    void release(GLuint texture);
+
+    size_t idleTextures() const;
+
+protected:
+    GLuint createTexture(GLenum internalFormat, int width, int height);
+
+private:
+    struct Key {
+        GLenum internalFormat;
+        int width;
+        int height;
+
+        bool operator==(const Key& other) const {
+            return internalFormat == other.internalFormat && width == other.width && height == other.height;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return ((size_t)key.internalFormat * 31 + (size_t)key.width) * 31 + (size_t)key.height;
+        }
+    };
+
+    // Idle textures above this are deleted on release
+    static const size_t kMaxIdleTextures = 64;
+
+    std::unordered_map<Key, std::vector<GLuint>, KeyHash> _idleTextures;
+
+    // key: texture acquired from the pool
+    std::unordered_map<GLuint, Key> _usedTextures;
+
+    size_t _idleCount = 0;
+};
@@ -8,6 +8,7 @@
 *************************************************************************/
 
 #include "video_shader.h"
+#include "shader_program_cache.h"
 #include <algorithm>
 #include <array>
 #include <memory>
@@ -63,7 +64,7 @@ FRAGMENT_SHADER_OUT
 "    mediump float y;\n"
 "    mediump vec2 uv;\n"
 "    y = " FRAGMENT_SHADER_TEXTURE "(s_textureY, v_texcoord).r;\n"
-"    uv = " FRAGMENT_SHADER_TEXTURE "(s_textureUV, v_texcoord).ra -\n"
+"    uv = " FRAGMENT_SHADER_TEXTURE "(s_textureUV, v_texcoord)." NV12_UV_SWIZZLE " -\n"
 "        vec2(0.5, 0.5);\n"
 "    " FRAGMENT_SHADER_COLOR " = vec4(y + 1.403 * uv.y,\n"
 "                                     y - 0.344 * uv.x - 0.714 * uv.y,\n"
@@ -71,110 +72,48 @@ FRAGMENT_SHADER_OUT
 "                                     1.0);\n"
 "  }\n";
 
+// Same conversion as I420, 10 bit samples are stored in the low bits of 16 bit textures
+// so they are rescaled to [0, 1] first.
+static const char kI010FragmentShaderSource[] =
+SHADER_VERSION
+"precision highp float;"
+FRAGMENT_SHADER_IN " vec2 v_texcoord;\n"
+"uniform highp sampler2D s_textureY;\n"
+"uniform highp sampler2D s_textureU;\n"
+"uniform highp sampler2D s_textureV;\n"
+FRAGMENT_SHADER_OUT
+"const float kScale = 65535.0 / 1023.0;\n"
+"void main() {\n"
+"    float y, u, v, r, g, b;\n"
+"    y = " FRAGMENT_SHADER_TEXTURE "(s_textureY, v_texcoord).r * kScale;\n"
+"    u = " FRAGMENT_SHADER_TEXTURE "(s_textureU, v_texcoord).r * kScale;\n"
+"    v = " FRAGMENT_SHADER_TEXTURE "(s_textureV, v_texcoord).r * kScale;\n"
+"    u = u - 0.5;\n"
+"    v = v - 0.5;\n"
+"    r = y + 1.403 * v;\n"
+"    g = y - 0.344 * u - 0.714 * v;\n"
+"    b = y + 1.770 * u;\n"
+"    " FRAGMENT_SHADER_COLOR " = vec4(r, g, b, 1.0);\n"
+"  }\n";
 
-VideoShader::VideoShader()
+VideoShader::VideoShader(std::shared_ptr<ShaderProgramCache> programCache)
+    : _programCache(programCache ? programCache : ShaderProgramCache::forShareGroup(nullptr))
 {
 
 }
 
 VideoShader::~VideoShader()
 {
-    glDeleteProgram(_i420Program);
-    glDeleteProgram(_nv12Program);
     glDeleteBuffers(1, &_vertexBuffer);
     glDeleteVertexArrays(1, &_vertexArray);
 }
 
-// Compiles a shader of the given |type| with GLSL source |source| and returns
-// the shader handle or 0 on error.
-GLuint VideoShader::createShader(GLenum type, const GLchar *source) {
-    GLuint shader = glCreateShader(type);
-    if (!shader) {
-        return 0;
-    }
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
-    GLint compileStatus = GL_FALSE;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
-    if (compileStatus == GL_FALSE) {
-        GLint logLength = 0;
-        // The null termination character is included in the returned log length.
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
-        if (logLength > 0) {
-            std::unique_ptr<char[]> compileLog(new char[logLength]);
-            // The returned string is null terminated.
-            glGetShaderInfoLog(shader, logLength, NULL, compileLog.get());
-            DLOG("Shader compile error: {}", compileLog.get());
-        }
-        glDeleteShader(shader);
-        shader = 0;
-    }
-    return shader;
-}
-
-// Links a shader program with the given vertex and fragment shaders and
-// returns the program handle or 0 on error.
-GLuint VideoShader::createProgram(GLuint vertexShader, GLuint fragmentShader) {
-    if (vertexShader == 0 || fragmentShader == 0) {
-        return 0;
-    }
-    GLuint program = glCreateProgram();
-    if (!program) {
-        return 0;
-    }
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-    GLint linkStatus = GL_FALSE;
-    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-    if (linkStatus == GL_FALSE) {
-        glDeleteProgram(program);
-        program = 0;
-    }
-    return program;
-}
-
-// Creates and links a shader program with the given fragment shader source and
-// a plain vertex shader. Returns the program handle or 0 on error.
-GLuint VideoShader::createProgramFromFragmentSource(const char fragmentShaderSource[]) {
-    GLuint vertexShader = createShader(GL_VERTEX_SHADER, kRTCVertexShaderSource);
-    //RTC_CHECK(vertexShader) << "failed to create vertex shader";
-    if (vertexShader == 0) {
-        DLOG("failed to create vertex shader");
-    }
-    GLuint fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    //RTC_CHECK(fragmentShader) << "failed to create fragment shader";
-    if (fragmentShader == 0) {
-        DLOG("failed to create fragment shader");
-    }
-    GLuint program = createProgram(vertexShader, fragmentShader);
-    // Shaders are created only to generate program.
-    if (vertexShader) {
-        glDeleteShader(vertexShader);
-    }
-    if (fragmentShader) {
-        glDeleteShader(fragmentShader);
-    }
-
-    // Set vertex shader variables 'position' and 'texcoord' in program.
-    GLint position = glGetAttribLocation(program, "position");
-    GLint texcoord = glGetAttribLocation(program, "texcoord");
-    if (position < 0 || texcoord < 0) {
-        glDeleteProgram(program);
-        return 0;
-    }
-
-    // Read position attribute with size of 2 and stride of 4 beginning at the start of the array. The
-    // last argument indicates offset of data within the vertex buffer.
-    glVertexAttribPointer(position, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void *)0);
-    glEnableVertexAttribArray(position);
-
-    // Read texcoord attribute  with size of 2 and stride of 4 beginning at the first texcoord in the
-    // array. The last argument indicates offset of data within the vertex buffer.
-    glVertexAttribPointer(texcoord, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void *)(2 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(texcoord);
-
-    return program;
+// Returns the program linking the fragment shader source with the plain vertex shader, compiled once
+// per share group. Returns the program handle or 0 on error.
+GLuint VideoShader::createProgramFromFragmentSource(const char* name,
+    const char fragmentShaderSource[],
+    const std::function<bool(GLuint)>& setup) {
+    return _programCache->program(name, kRTCVertexShaderSource, fragmentShaderSource, setup);
 }
 
 bool VideoShader::createVertexBuffer(GLuint *vertexBuffer, GLuint *vertexArray) {
@@ -191,6 +130,19 @@ bool VideoShader::createVertexBuffer(GLuint *vertexBuffer, GLuint *vertexArray)
     }
     glBindBuffer(GL_ARRAY_BUFFER, *vertexBuffer);
     glBufferData(GL_ARRAY_BUFFER, 4 * 4 * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+
+    // Vertex arrays are not shared between contexts, every shader records its own attribute layout
+    // against the locations bound by the program cache.
+
+    // Read position attribute with size of 2 and stride of 4 beginning at the start of the array. The
+    // last argument indicates offset of data within the vertex buffer.
+    glVertexAttribPointer(kPositionAttribute, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void *)0);
+    glEnableVertexAttribArray(kPositionAttribute);
+
+    // Read texcoord attribute  with size of 2 and stride of 4 beginning at the first texcoord in the
+    // array. The last argument indicates offset of data within the vertex buffer.
+    glVertexAttribPointer(kTexcoordAttribute, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void *)(2 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(kTexcoordAttribute);
     return true;
 }
 
@@ -242,50 +194,61 @@ void VideoShader::setVertexData(webrtc::VideoRotation rotation) {
 
 bool VideoShader::createAndSetupI420Program() {
     assert(!_i420Program);
-    _i420Program = createProgramFromFragmentSource(kI420FragmentShaderSource);
-    if (!_i420Program) {
-        return false;
-    }
-    GLint ySampler = glGetUniformLocation(_i420Program, "s_textureY");
-    GLint uSampler = glGetUniformLocation(_i420Program, "s_textureU");
-    GLint vSampler = glGetUniformLocation(_i420Program, "s_textureV");
-
-    if (ySampler < 0 || uSampler < 0 || vSampler < 0) {
-        DLOG("Failed to get uniform variable locations in I420 shader");
-        glDeleteProgram(_i420Program);
-        _i420Program = 0;
-        return false;
-    }
-
-    glUseProgram(_i420Program);
-    glUniform1i(ySampler, kYTextureUnit);
-    glUniform1i(uSampler, kUTextureUnit);
-    glUniform1i(vSampler, kVTextureUnit);
+    // Sampler units are program state, they are set once for the whole share group
+    _i420Program = createProgramFromFragmentSource("i420", kI420FragmentShaderSource, [](GLuint program) {
+        GLint ySampler = glGetUniformLocation(program, "s_textureY");
+        GLint uSampler = glGetUniformLocation(program, "s_textureU");
+        GLint vSampler = glGetUniformLocation(program, "s_textureV");
+
+        if (ySampler < 0 || uSampler < 0 || vSampler < 0) {
+            DLOG("Failed to get uniform variable locations in I420 shader");
+            return false;
+        }
 
-    return true;
+        glUniform1i(ySampler, kYTextureUnit);
+        glUniform1i(uSampler, kUTextureUnit);
+        glUniform1i(vSampler, kVTextureUnit);
+        return true;
+    });
+    return _i420Program != 0;
 }
 
 bool VideoShader::createAndSetupNV12Program() {
     assert(!_nv12Program);
-    _nv12Program = createProgramFromFragmentSource(kNV12FragmentShaderSource);
-    if (!_nv12Program) {
-        return false;
-    }
-    GLint ySampler = glGetUniformLocation(_nv12Program, "s_textureY");
-    GLint uvSampler = glGetUniformLocation(_nv12Program, "s_textureUV");
+    _nv12Program = createProgramFromFragmentSource("nv12", kNV12FragmentShaderSource, [](GLuint program) {
+        GLint ySampler = glGetUniformLocation(program, "s_textureY");
+        GLint uvSampler = glGetUniformLocation(program, "s_textureUV");
 
-    if (ySampler < 0 || uvSampler < 0) {
-        DLOG("Failed to get uniform variable locations in NV12 shader");
-        glDeleteProgram(_nv12Program);
-        _nv12Program = 0;
-        return false;
-    }
+        if (ySampler < 0 || uvSampler < 0) {
+            DLOG("Failed to get uniform variable locations in NV12 shader");
+            return false;
+        }
 
-    glUseProgram(_nv12Program);
-    glUniform1i(ySampler, kYTextureUnit);
-    glUniform1i(uvSampler, kUvTextureUnit);
+        glUniform1i(ySampler, kYTextureUnit);
+        glUniform1i(uvSampler, kUvTextureUnit);
+        return true;
+    });
+    return _nv12Program != 0;
+}
 
-    return true;
+bool VideoShader::createAndSetupI010Program() {
+    assert(!_i010Program);
+    _i010Program = createProgramFromFragmentSource("i010", kI010FragmentShaderSource, [](GLuint program) {
+        GLint ySampler = glGetUniformLocation(program, "s_textureY");
+        GLint uSampler = glGetUniformLocation(program, "s_textureU");
+        GLint vSampler = glGetUniformLocation(program, "s_textureV");
+
+        if (ySampler < 0 || uSampler < 0 || vSampler < 0) {
+            DLOG("Failed to get uniform variable locations in I010 shader");
+            return false;
+        }
+
+        glUniform1i(ySampler, kYTextureUnit);
+        glUniform1i(uSampler, kUTextureUnit);
+        glUniform1i(vSampler, kVTextureUnit);
+        return true;
+    });
+    return _i010Program != 0;
 }
 
 bool VideoShader::prepareVertexBuffer(webrtc::VideoRotation rotation) {
@@ -358,4 +321,31 @@ void VideoShader::applyShadingForFrame(int width,
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 }
 
+void VideoShader::applyShadingForI010Frame(int width,
+    int height,
+    webrtc::VideoRotation rotation,
+    GLuint yPlane,
+    GLuint uPlane,
+    GLuint vPlane) {
+    if (!prepareVertexBuffer(rotation)) {
+        return;
+    }
+
+    if (!_i010Program && !createAndSetupI010Program()) {
+        DLOG("Failed to setup I010 program");
+        return;
+    }
 
+    glUseProgram(_i010Program);
+
+    glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + kYTextureUnit));
+    glBindTexture(GL_TEXTURE_2D, yPlane);
+
+    glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + kUTextureUnit));
+    glBindTexture(GL_TEXTURE_2D, uPlane);
+
+    glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + kVTextureUnit));
+    glBindTexture(GL_TEXTURE_2D, vPlane);
+
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+}
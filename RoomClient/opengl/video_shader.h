@@ -11,14 +11,18 @@
 
 #include "gl_defines.h"
 #include <memory>
+#include <functional>
 #include "absl/types/optional.h"
 #include "api/video/video_rotation.h"
 
+class ShaderProgramCache;
+
 class VideoShader
     : public std::enable_shared_from_this<VideoShader>
 {
 public:
-    VideoShader();
+    // Programs come from |programCache|, nullptr gives the shader a cache of its own
+    explicit VideoShader(std::shared_ptr<ShaderProgramCache> programCache = nullptr);
 
     ~VideoShader();
 
@@ -26,6 +30,8 @@ public:
 
     bool createAndSetupNV12Program();
 
+    bool createAndSetupI010Program();
+
     bool prepareVertexBuffer(webrtc::VideoRotation rotation);
 
     void applyShadingForFrame(int width,
@@ -41,18 +47,25 @@ public:
         GLuint yPlane,
         GLuint uvPlane);
 
-protected:
-    GLuint createShader(GLenum type, const GLchar* source);
-
-    GLuint createProgram(GLuint vertexShader, GLuint fragmentShader);
+    void applyShadingForI010Frame(int width,
+        int height,
+        webrtc::VideoRotation rotation,
+        GLuint yPlane,
+        GLuint uPlane,
+        GLuint vPlane);
 
-    GLuint createProgramFromFragmentSource(const char fragmentShaderSource[]);
+protected:
+    GLuint createProgramFromFragmentSource(const char* name,
+        const char fragmentShaderSource[],
+        const std::function<bool(GLuint)>& setup);
 
     bool createVertexBuffer(GLuint* vertexBuffer, GLuint* vertexArray);
 
     void setVertexData(webrtc::VideoRotation rotation);
 
 private:
+    std::shared_ptr<ShaderProgramCache> _programCache;
+
     GLuint _vertexBuffer = 0;
 
     GLuint _vertexArray = 0;
@@ -60,8 +73,11 @@ private:
     // Store current rotation and only upload new vertex data when rotation changes.
     absl::optional<webrtc::VideoRotation> _currentRotation;
 
+    // Owned by _programCache
     GLuint _i420Program = 0;
 
     GLuint _nv12Program = 0;
+
+    GLuint _i010Program = 0;
 };
 
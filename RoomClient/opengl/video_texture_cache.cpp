@@ -0,0 +1,121 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "video_texture_cache.h"
+#include "i010_texture_cache.h"
+#include "nv12_texture_cache.h"
+#include "video_shader.h"
+#include "api/video/video_frame_buffer.h"
+
+VideoTextureCache::VideoTextureCache()
+{
+
+}
+
+VideoTextureCache::~VideoTextureCache()
+{
+
+}
+
+void VideoTextureCache::init(I420TextureCache::UploadMode mode, std::shared_ptr<TexturePool> texturePool)
+{
+    _i420Mode = mode;
+    _texturePool = texturePool;
+}
+
+void VideoTextureCache::recycle()
+{
+    if (_i420TextureCache) {
+        _i420TextureCache->recycle();
+    }
+    _format = Format::None;
+}
+
+bool VideoTextureCache::uploadFrameToTextures(const webrtc::VideoFrame& frame)
+{
+    return uploadBuffer(frame.video_frame_buffer());
+}
+
+bool VideoTextureCache::uploadBuffer(const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& vfb)
+{
+    if (!vfb) {
+        return false;
+    }
+
+    switch (vfb->type()) {
+    case webrtc::VideoFrameBuffer::Type::kNV12:
+        if (!_nv12TextureCache) {
+            _nv12TextureCache = std::make_shared<NV12TextureCache>();
+            _nv12TextureCache->init();
+        }
+        _nv12TextureCache->uploadFrameToTextures(*vfb->GetNV12());
+        _format = Format::NV12;
+        return true;
+#if RTC_HAS_16BIT_TEXTURES
+    case webrtc::VideoFrameBuffer::Type::kI010:
+        if (!_i010TextureCache) {
+            _i010TextureCache = std::make_shared<I010TextureCache>();
+            _i010TextureCache->init();
+        }
+        _i010TextureCache->uploadFrameToTextures(*vfb->GetI010());
+        _format = Format::I010;
+        return true;
+#endif
+    case webrtc::VideoFrameBuffer::Type::kNative: {
+        // Hardware decoders usually hold NV12 internally, mapping it avoids ToI420()
+        const webrtc::VideoFrameBuffer::Type types[] = { webrtc::VideoFrameBuffer::Type::kNV12, webrtc::VideoFrameBuffer::Type::kI420 };
+        auto mapped = vfb->GetMappedFrameBuffer(types);
+        if (mapped && mapped->type() != webrtc::VideoFrameBuffer::Type::kNative) {
+            return uploadBuffer(mapped);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (!_i420TextureCache) {
+        _i420TextureCache = std::make_shared<I420TextureCache>();
+        _i420TextureCache->init(_i420Mode, _texturePool);
+    }
+    _i420TextureCache->uploadBufferToTextures(vfb);
+    _format = Format::I420;
+    return true;
+}
+
+void VideoTextureCache::draw(VideoShader& shader, int width, int height, webrtc::VideoRotation rotation)
+{
+    switch (_format) {
+    case Format::I420:
+        shader.applyShadingForFrame(width,
+            height,
+            rotation,
+            _i420TextureCache->yTexture(),
+            _i420TextureCache->uTexture(),
+            _i420TextureCache->vTexture());
+        break;
+    case Format::NV12:
+        shader.applyShadingForFrame(width,
+            height,
+            rotation,
+            _nv12TextureCache->yTexture(),
+            _nv12TextureCache->uvTexture());
+        break;
+    case Format::I010:
+        shader.applyShadingForI010Frame(width,
+            height,
+            rotation,
+            _i010TextureCache->yTexture(),
+            _i010TextureCache->uTexture(),
+            _i010TextureCache->vTexture());
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,70 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include "gl_defines.h"
+#include <memory>
+#include "api/video/video_frame.h"
+#include "api/video/video_rotation.h"
+#include "i420_texture_cache.h"
+
+class VideoShader;
+class NV12TextureCache;
+class I010TextureCache;
+class TexturePool;
+
+// Uploads frames in their native pixel layout and draws them with the matching shader program:
+// NV12 as Y + UV textures, I010 as 16 bit planes, everything else as I420. Native buffers that
+// can be mapped to NV12 are uploaded without a CPU conversion.
+class VideoTextureCache
+    : public std::enable_shared_from_this<VideoTextureCache>
+{
+public:
+    VideoTextureCache();
+
+    ~VideoTextureCache();
+
+public:
+    // The mode and the pool apply to the I420 path
+    void init(I420TextureCache::UploadMode mode = I420TextureCache::UploadMode::Direct, std::shared_ptr<TexturePool> texturePool = nullptr);
+
+    // Returns false when the frame carries no buffer
+    bool uploadFrameToTextures(const webrtc::VideoFrame& frame);
+
+    // Draws the textures of the last upload
+    void draw(VideoShader& shader, int width, int height, webrtc::VideoRotation rotation);
+
+    // Gives pooled textures back while nothing is shown
+    void recycle();
+
+protected:
+    bool uploadBuffer(const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& vfb);
+
+private:
+    enum class Format {
+        None,
+        I420,
+        NV12,
+        I010
+    };
+
+    Format _format = Format::None;
+
+    I420TextureCache::UploadMode _i420Mode = I420TextureCache::UploadMode::Direct;
+
+    std::shared_ptr<TexturePool> _texturePool;
+
+    // Created on the first frame of their format, with the GL context current
+    std::shared_ptr<I420TextureCache> _i420TextureCache;
+
+    std::shared_ptr<NV12TextureCache> _nv12TextureCache;
+
+    std::shared_ptr<I010TextureCache> _i010TextureCache;
+};
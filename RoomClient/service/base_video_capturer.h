@@ -15,9 +15,8 @@
 
 #include "api/video/video_frame.h"
 #include "api/video/video_source_interface.h"
-#include "media/base/video_adapter.h"
-#include "media/base/video_broadcaster.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "service/frame_fanout.h"
 
 namespace vi {
 
@@ -42,18 +41,21 @@ public:
         preprocessor_ = std::move(preprocessor);
     }
 
+    // Reuse of the buffers adapted frames are scaled into
+    CaptureBufferPool::Stats GetScalePoolStats() const {
+        return fanout_.GetPoolStats();
+    }
+
 protected:
     void OnFrame(const VideoFrame& frame);
     rtc::VideoSinkWants GetSinkWants();
 
 private:
-    void UpdateVideoAdapter();
     VideoFrame MaybePreprocess(const VideoFrame& frame);
 
     Mutex lock_;
     std::unique_ptr<FramePreprocessor> preprocessor_ RTC_GUARDED_BY(lock_);
-    rtc::VideoBroadcaster broadcaster_;
-    cricket::VideoAdapter video_adapter_;
+    FrameFanout fanout_;
 };
 
 }  // namespace vi
@@ -0,0 +1,115 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "capture_buffer_pool.h"
+#include "libyuv/scale.h"
+
+namespace vi {
+
+using namespace webrtc;
+
+CaptureBufferPool::CaptureBufferPool()
+    : pool_(/*zero_initialize=*/false, kMaxBuffers) {
+}
+
+rtc::scoped_refptr<I420Buffer> CaptureBufferPool::CreateI420Buffer(int width, int height) {
+    rtc::scoped_refptr<I420Buffer> buffer = pool_.CreateI420Buffer(width, height);
+    if (!Track(buffer.get(), VideoFrameBuffer::Type::kI420, width, height)) {
+        // Every pooled buffer is still in flight, keep the frame rather than drop it
+        return I420Buffer::Create(width, height);
+    }
+    return buffer;
+}
+
+rtc::scoped_refptr<NV12Buffer> CaptureBufferPool::CreateNV12Buffer(int width, int height) {
+    rtc::scoped_refptr<NV12Buffer> buffer = pool_.CreateNV12Buffer(width, height);
+    if (!Track(buffer.get(), VideoFrameBuffer::Type::kNV12, width, height)) {
+        return NV12Buffer::Create(width, height);
+    }
+    return buffer;
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> CaptureBufferPool::CropAndScale(const rtc::scoped_refptr<VideoFrameBuffer>& source,
+                                                                     int cropped_width,
+                                                                     int cropped_height,
+                                                                     int out_width,
+                                                                     int out_height) {
+    // Even offsets keep the chroma planes aligned with luma
+    const int offset_x = ((source->width() - cropped_width) / 2) & ~1;
+    const int offset_y = ((source->height() - cropped_height) / 2) & ~1;
+
+    switch (source->type()) {
+    case VideoFrameBuffer::Type::kNV12: {
+        const NV12BufferInterface* src = source->GetNV12();
+        const int uv_offset = (offset_y / 2) * src->StrideUV() + offset_x;
+        rtc::scoped_refptr<NV12Buffer> buffer = CreateNV12Buffer(out_width, out_height);
+        libyuv::NV12Scale(src->DataY() + offset_y * src->StrideY() + offset_x, src->StrideY(),
+                          src->DataUV() + uv_offset, src->StrideUV(),
+                          cropped_width, cropped_height,
+                          buffer->MutableDataY(), buffer->StrideY(),
+                          buffer->MutableDataUV(), buffer->StrideUV(),
+                          out_width, out_height, libyuv::kFilterBox);
+        return buffer;
+    }
+    case VideoFrameBuffer::Type::kNative:
+        return source->CropAndScale(offset_x, offset_y, cropped_width, cropped_height, out_width, out_height);
+    default:
+        break;
+    }
+
+    // I420 needs no conversion, ToI420() returns the buffer itself
+    rtc::scoped_refptr<I420BufferInterface> src = source->ToI420();
+    if (!src) {
+        return nullptr;
+    }
+    const int u_offset = (offset_y / 2) * src->StrideU() + offset_x / 2;
+    const int v_offset = (offset_y / 2) * src->StrideV() + offset_x / 2;
+    rtc::scoped_refptr<I420Buffer> buffer = CreateI420Buffer(out_width, out_height);
+    libyuv::I420Scale(src->DataY() + offset_y * src->StrideY() + offset_x, src->StrideY(),
+                      src->DataU() + u_offset, src->StrideU(),
+                      src->DataV() + v_offset, src->StrideV(),
+                      cropped_width, cropped_height,
+                      buffer->MutableDataY(), buffer->StrideY(),
+                      buffer->MutableDataU(), buffer->StrideU(),
+                      buffer->MutableDataV(), buffer->StrideV(),
+                      out_width, out_height, libyuv::kFilterBox);
+    return buffer;
+}
+
+CaptureBufferPool::Stats CaptureBufferPool::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool CaptureBufferPool::Track(const VideoFrameBuffer* buffer, VideoFrameBuffer::Type type, int width, int height) {
+    if (type != type_ || width != width_ || height != height_) {
+        // The pool releases buffers of another size or format on its own
+        known_buffers_.clear();
+        type_ = type;
+        width_ = width;
+        height_ = height;
+    }
+
+    if (!buffer) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (known_buffers_.insert(buffer).second) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+}  // namespace vi
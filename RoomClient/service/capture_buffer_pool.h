@@ -0,0 +1,75 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <unordered_set>
+
+#include "api/scoped_refptr.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "common_video/include/video_frame_buffer_pool.h"
+
+namespace vi {
+
+// Recycles the I420 / NV12 buffers capturers scale adapted frames into. A buffer goes back to the
+// pool once every frame referencing it is gone, so steady state capture at a fixed output size
+// allocates nothing per frame. A change of size or format drops the buffers of the old one.
+class CaptureBufferPool {
+public:
+    struct Stats {
+        // Served from a recycled buffer
+        uint64_t hits = 0;
+        // Had to allocate, first use of a size or every pooled buffer still in flight
+        uint64_t misses = 0;
+    };
+
+    // Bounds how many frames may be in flight at once before the pool stops growing
+    static const size_t kMaxBuffers = 8;
+
+    CaptureBufferPool();
+
+    rtc::scoped_refptr<webrtc::I420Buffer> CreateI420Buffer(int width, int height);
+
+    rtc::scoped_refptr<webrtc::NV12Buffer> CreateNV12Buffer(int width, int height);
+
+    // Crops the centered |cropped_width| x |cropped_height| region of |source| and scales it to
+    // |out_width| x |out_height| in a single libyuv pass into a pooled buffer. I420 and NV12 sources
+    // keep their format, native ones scale themselves and anything else goes through I420 first.
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> CropAndScale(const rtc::scoped_refptr<webrtc::VideoFrameBuffer>& source,
+                                                              int cropped_width,
+                                                              int cropped_height,
+                                                              int out_width,
+                                                              int out_height);
+
+    // Safe to call from any thread
+    Stats GetStats() const;
+
+private:
+    // Counts the outcome of a pool request for the given size and format, false when the pool had
+    // no free buffer
+    bool Track(const webrtc::VideoFrameBuffer* buffer, webrtc::VideoFrameBuffer::Type type, int width, int height);
+
+    webrtc::VideoFrameBufferPool pool_;
+
+    // Buffers the pool has handed out at the current size and format, a pointer seen before means reuse
+    std::unordered_set<const webrtc::VideoFrameBuffer*> known_buffers_;
+    webrtc::VideoFrameBuffer::Type type_ = webrtc::VideoFrameBuffer::Type::kI420;
+    int width_ = 0;
+    int height_ = 0;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace vi
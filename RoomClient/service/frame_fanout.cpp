@@ -0,0 +1,191 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "frame_fanout.h"
+#include <algorithm>
+#include "api/video/i420_buffer.h"
+
+namespace {
+
+// A resolution nobody asked for in this many frames gives its buffers back, a sink that only
+// drops frames for its frame rate keeps its pool
+const uint64_t kPoolIdleFrames = 60;
+
+}  // namespace
+
+namespace vi {
+
+FrameFanout::FrameFanout() = default;
+
+FrameFanout::~FrameFanout() = default;
+
+void FrameFanout::AddOrUpdateSink(rtc::VideoSinkInterface<VideoFrame>* sink, const rtc::VideoSinkWants& wants) {
+    MutexLock lock(&lock_);
+    auto it = std::find_if(sinks_.begin(), sinks_.end(), [sink](const SinkEntry& entry) {
+        return entry.sink == sink;
+    });
+    if (it == sinks_.end()) {
+        SinkEntry entry;
+        entry.sink = sink;
+        entry.adapter = std::make_unique<cricket::VideoAdapter>();
+        sinks_.push_back(std::move(entry));
+        it = sinks_.end() - 1;
+    }
+    it->wants = wants;
+    it->adapter->OnSinkWants(wants);
+}
+
+void FrameFanout::RemoveSink(rtc::VideoSinkInterface<VideoFrame>* sink) {
+    MutexLock lock(&lock_);
+    sinks_.erase(std::remove_if(sinks_.begin(), sinks_.end(), [sink](const SinkEntry& entry) {
+        return entry.sink == sink;
+    }), sinks_.end());
+}
+
+void FrameFanout::OnFrame(const VideoFrame& frame) {
+    MutexLock lock(&lock_);
+    ++frame_count_;
+
+    // Frames already produced for this captured frame, one per distinct adaptation
+    std::vector<std::pair<Adaptation, VideoFrame>> outputs;
+    outputs.reserve(sinks_.size());
+
+    for (SinkEntry& entry : sinks_) {
+        Adaptation adaptation;
+        if (!entry.adapter->AdaptFrameResolution(
+                    frame.width(), frame.height(), frame.timestamp_us() * 1000,
+                    &adaptation.cropped_width, &adaptation.cropped_height,
+                    &adaptation.out_width, &adaptation.out_height)) {
+            // Drop frame in order to respect this sink's frame rate constraint.
+            continue;
+        }
+
+        if (entry.wants.black_frames) {
+            entry.sink->OnFrame(BlackFrame(frame));
+            continue;
+        }
+
+        auto it = std::find_if(outputs.begin(), outputs.end(), [&adaptation](const std::pair<Adaptation, VideoFrame>& output) {
+            return output.first == adaptation;
+        });
+        if (it == outputs.end()) {
+            outputs.emplace_back(adaptation, Adapt(frame, adaptation));
+            it = outputs.end() - 1;
+        }
+        entry.sink->OnFrame(it->second);
+    }
+
+    DropIdlePools();
+}
+
+rtc::VideoSinkWants FrameFanout::wants() const {
+    MutexLock lock(&lock_);
+    rtc::VideoSinkWants wants;
+    if (sinks_.empty()) {
+        return wants;
+    }
+
+    wants.rotation_applied = false;
+    wants.black_frames = true;
+    wants.max_pixel_count = 0;
+    wants.max_framerate_fps = 0;
+    for (const SinkEntry& entry : sinks_) {
+        wants.rotation_applied = wants.rotation_applied || entry.wants.rotation_applied;
+        wants.black_frames = wants.black_frames && entry.wants.black_frames;
+        wants.max_pixel_count = std::max(wants.max_pixel_count, entry.wants.max_pixel_count);
+        wants.max_framerate_fps = std::max(wants.max_framerate_fps, entry.wants.max_framerate_fps);
+        if (entry.wants.target_pixel_count) {
+            wants.target_pixel_count = std::max(wants.target_pixel_count.value_or(0), *entry.wants.target_pixel_count);
+        }
+    }
+    return wants;
+}
+
+CaptureBufferPool::Stats FrameFanout::GetPoolStats() const {
+    MutexLock lock(&lock_);
+    CaptureBufferPool::Stats stats = dropped_pool_stats_;
+    for (const auto& pool : pools_) {
+        const CaptureBufferPool::Stats poolStats = pool.second.pool->GetStats();
+        stats.hits += poolStats.hits;
+        stats.misses += poolStats.misses;
+    }
+    return stats;
+}
+
+VideoFrame FrameFanout::Adapt(const VideoFrame& frame, const Adaptation& adaptation) {
+    if (adaptation.out_width == frame.width() && adaptation.out_height == frame.height()) {
+        // No adaptations needed, just return the frame as is.
+        return frame;
+    }
+
+    // Buffers of different sizes live in different pools, a single pool would throw its buffers
+    // away every time the requested size changes
+    PoolEntry& entry = pools_[std::make_pair(adaptation.out_width, adaptation.out_height)];
+    if (!entry.pool) {
+        entry.pool = std::make_unique<CaptureBufferPool>();
+    }
+    entry.last_used_frame = frame_count_;
+
+    rtc::scoped_refptr<VideoFrameBuffer> scaled_buffer =
+            entry.pool->CropAndScale(frame.video_frame_buffer(), adaptation.cropped_width,
+                                     adaptation.cropped_height, adaptation.out_width, adaptation.out_height);
+    if (!scaled_buffer) {
+        return frame;
+    }
+
+    VideoFrame::Builder new_frame_builder =
+            VideoFrame::Builder()
+            .set_video_frame_buffer(scaled_buffer)
+            .set_rotation(frame.rotation())
+            .set_timestamp_us(frame.timestamp_us())
+            .set_id(frame.id());
+    if (frame.has_update_rect()) {
+        VideoFrame::UpdateRect new_rect = frame.update_rect().ScaleWithFrame(
+                    frame.width(), frame.height(),
+                    ((frame.width() - adaptation.cropped_width) / 2) & ~1,
+                    ((frame.height() - adaptation.cropped_height) / 2) & ~1,
+                    adaptation.cropped_width, adaptation.cropped_height,
+                    adaptation.out_width, adaptation.out_height);
+        new_frame_builder.set_update_rect(new_rect);
+    }
+    return new_frame_builder.build();
+}
+
+VideoFrame FrameFanout::BlackFrame(const VideoFrame& frame) {
+    if (!black_frame_buffer_ ||
+        black_frame_buffer_->width() != frame.width() ||
+        black_frame_buffer_->height() != frame.height()) {
+        rtc::scoped_refptr<I420Buffer> buffer = I420Buffer::Create(frame.width(), frame.height());
+        I420Buffer::SetBlack(buffer.get());
+        black_frame_buffer_ = buffer;
+    }
+
+    return VideoFrame::Builder()
+            .set_video_frame_buffer(black_frame_buffer_)
+            .set_rotation(frame.rotation())
+            .set_timestamp_us(frame.timestamp_us())
+            .set_id(frame.id())
+            .build();
+}
+
+void FrameFanout::DropIdlePools() {
+    for (auto it = pools_.begin(); it != pools_.end();) {
+        if (frame_count_ - it->second.last_used_frame > kPoolIdleFrames) {
+            const CaptureBufferPool::Stats stats = it->second.pool->GetStats();
+            dropped_pool_stats_.hits += stats.hits;
+            dropped_pool_stats_.misses += stats.misses;
+            it = pools_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+}  // namespace vi
@@ -0,0 +1,99 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/video/video_frame.h"
+#include "api/video/video_sink_interface.h"
+#include "api/video/video_source_interface.h"
+#include "media/base/video_adapter.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "service/capture_buffer_pool.h"
+
+namespace vi {
+
+using namespace webrtc;
+
+// Hands captured frames to every sink at the resolution its VideoSinkWants ask for. Each sink
+// gets its own VideoAdapter, sinks that end up with the same crop and output size share one
+// ref-counted buffer, so every distinct resolution is scaled once per captured frame no matter
+// how many sinks want it. Takes the place of rtc::VideoBroadcaster plus a single adapter, which
+// scaled everything to the most restrictive wants of all sinks.
+class FrameFanout : public rtc::VideoSinkInterface<VideoFrame> {
+public:
+    FrameFanout();
+
+    ~FrameFanout() override;
+
+    void AddOrUpdateSink(rtc::VideoSinkInterface<VideoFrame>* sink, const rtc::VideoSinkWants& wants);
+
+    void RemoveSink(rtc::VideoSinkInterface<VideoFrame>* sink);
+
+    void OnFrame(const VideoFrame& frame) override;
+
+    // What the source has to deliver to satisfy every sink: the largest size and highest frame
+    // rate any of them asked for
+    rtc::VideoSinkWants wants() const;
+
+    // Summed over the per-resolution pools, including ones already dropped
+    CaptureBufferPool::Stats GetPoolStats() const;
+
+private:
+    struct SinkEntry {
+        rtc::VideoSinkInterface<VideoFrame>* sink = nullptr;
+        rtc::VideoSinkWants wants;
+        std::unique_ptr<cricket::VideoAdapter> adapter;
+    };
+
+    struct PoolEntry {
+        std::unique_ptr<CaptureBufferPool> pool;
+        uint64_t last_used_frame = 0;
+    };
+
+    // Crop and output size
+    struct Adaptation {
+        int cropped_width;
+        int cropped_height;
+        int out_width;
+        int out_height;
+
+        bool operator==(const Adaptation& other) const {
+            return cropped_width == other.cropped_width && cropped_height == other.cropped_height &&
+                   out_width == other.out_width && out_height == other.out_height;
+        }
+    };
+
+    VideoFrame Adapt(const VideoFrame& frame, const Adaptation& adaptation) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+    VideoFrame BlackFrame(const VideoFrame& frame) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+    void DropIdlePools() RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+    mutable Mutex lock_;
+
+    std::vector<SinkEntry> sinks_ RTC_GUARDED_BY(lock_);
+
+    // key: output width and height
+    std::map<std::pair<int, int>, PoolEntry> pools_ RTC_GUARDED_BY(lock_);
+
+    CaptureBufferPool::Stats dropped_pool_stats_ RTC_GUARDED_BY(lock_);
+
+    uint64_t frame_count_ RTC_GUARDED_BY(lock_) = 0;
+
+    rtc::scoped_refptr<VideoFrameBuffer> black_frame_buffer_ RTC_GUARDED_BY(lock_);
+};
+
+}  // namespace vi
@@ -0,0 +1,47 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include "api/video/video_frame.h"
+#include "api/video/video_sink_interface.h"
+
+namespace vi {
+
+// Sink of a remote video track that remembers the size of the latest decoded frame, i.e. the
+// resolution of the spatial layer the SFU forwards. Width and height are packed in one atomic so
+// a reader never sees them from two different frames.
+class FrameSizeProbe : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+public:
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+        // Sized as displayed, the rotation travels next to the frame
+        const bool transposed = frame.rotation() == webrtc::kVideoRotation_90 || frame.rotation() == webrtc::kVideoRotation_270;
+        const uint32_t width = (uint32_t)(transposed ? frame.height() : frame.width());
+        const uint32_t height = (uint32_t)(transposed ? frame.width() : frame.height());
+        const uint64_t size = ((uint64_t)width << 32) | height;
+        if (_size.load(std::memory_order_relaxed) != size) {
+            _size.store(size, std::memory_order_relaxed);
+        }
+    }
+
+    // False until the first frame arrived
+    bool size(int32_t& width, int32_t& height) const {
+        const uint64_t size = _size.load(std::memory_order_relaxed);
+        width = (int32_t)(size >> 32);
+        height = (int32_t)(size & 0xffffffff);
+        return size != 0;
+    }
+
+private:
+    std::atomic<uint64_t> _size { 0 };
+};
+
+}
@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include "api/scoped_refptr.h"
 
 namespace rtc {
@@ -69,6 +70,13 @@ public:
 
     virtual bool isVideoMuted(const std::string& pid) = 0;
 
+    // On-screen pixel size of the peer's video without letterboxing, picks the smallest spatial
+    // layer whose decoded size covers it
+    virtual void setPreferredVideoSize(const std::string& pid, int32_t width, int32_t height) = 0;
+
+    // Peers whose video is currently rendered, video consumers of every other peer are paused
+    virtual void setVisibleVideoPeers(const std::vector<std::string>& pids) = 0;
+
     virtual std::unordered_map<std::string, rtc::scoped_refptr<webrtc::MediaStreamTrackInterface>> getLocalVideoTracks() = 0;
 
     virtual std::unordered_map<std::string, rtc::scoped_refptr<webrtc::MediaStreamTrackInterface>> getRemoteAudioTracks(const std::string& pid) = 0;
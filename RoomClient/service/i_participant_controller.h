@@ -12,6 +12,7 @@
 #include <string>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include "utils/interface_proxy.hpp"
 
 namespace rtc {
@@ -45,6 +46,14 @@ public:
 
     virtual bool isVideoMuted(const std::string& pid) = 0;
 
+    // On-screen pixel size the peer's video is rendered at, the SFU is asked for the smallest
+    // spatial layer covering it
+    virtual void setPreferredVideoSize(const std::string& pid, int32_t width, int32_t height) = 0;
+
+    // Participants whose video is on screen, the others stop receiving video until they show up again.
+    // Never calling it keeps every video consumer running
+    virtual void setVisibleVideoParticipants(const std::vector<std::string>& pids) = 0;
+
 };
 
 BEGIN_PROXY_MAP(ParticipantController)
@@ -56,6 +65,8 @@ BEGIN_PROXY_MAP(ParticipantController)
     PROXY_METHOD1(bool, isAudioMuted, const std::string&)
     PROXY_METHOD2(void, muteVideo, const std::string&, bool)
     PROXY_METHOD1(bool, isVideoMuted, const std::string&)
+    PROXY_METHOD3(void, setPreferredVideoSize, const std::string&, int32_t, int32_t)
+    PROXY_METHOD1(void, setVisibleVideoParticipants, const std::vector<std::string>&)
 END_PROXY_MAP()
 
 }
@@ -11,11 +11,15 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <functional>
+#include "absl/strings/string_view.h"
 #include "i_signaling_event_handler.h"
+#include "websocket/request_latency_stats.h"
 
 namespace vi {
 
-using SuccessCallback = std::function<void(const std::string& json)>;
+using SuccessCallback = std::function<void(absl::string_view json)>;
 using FailureCallback = std::function<void(int32_t errorCode, const std::string& errorInfo)>;
 
 class ISignalingClient {
@@ -34,9 +38,14 @@ public:
 
     virtual void disconnect() = 0;
 
-    virtual void send(const std::string& text, int64_t transcation, SuccessCallback scb, FailureCallback fcb) = 0;
+    virtual void send(const std::string& text, int64_t transcation, const std::string& method, SuccessCallback scb, FailureCallback fcb) = 0;
 
-    virtual void send(const std::vector<uint8_t>& data, int64_t transcation, SuccessCallback scb, FailureCallback fcb) = 0;
+    virtual void send(const std::vector<uint8_t>& data, int64_t transcation, const std::string& method, SuccessCallback scb, FailureCallback fcb) = 0;
+
+    virtual std::vector<RequestLatencySnapshot> requestLatencyStats() = 0;
+
+    // Keep only the latest consumerScore/producerScore/activeSpeaker per id and deliver them once per window
+    virtual void setCoalescingWindow(uint32_t milliseconds) = 0;
 };
 
 }
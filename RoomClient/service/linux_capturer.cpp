@@ -0,0 +1,454 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "linux_capturer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "api/video/i420_buffer.h"
+#include "common_video/include/video_frame_buffer.h"
+#include "libyuv/convert.h"
+#include "rtc_base/time_utils.h"
+
+namespace {
+
+// Enough for the encoder to hold on to a frame or two while the driver keeps filling the rest
+const uint32_t kBufferCount = 4;
+
+// How long the capture thread blocks before it looks at running_ again
+const int kPollTimeoutMs = 100;
+
+// Formats in order of preference, I420 is the only one delivered without a copy
+const uint32_t kPreferredFormats[] = {
+    V4L2_PIX_FMT_YUV420,
+    V4L2_PIX_FMT_NV12,
+    V4L2_PIX_FMT_YUYV,
+    V4L2_PIX_FMT_UYVY,
+    V4L2_PIX_FMT_MJPEG,
+};
+
+int xioctl(int fd, unsigned long request, void* arg) {
+    int result;
+    do {
+        result = ioctl(fd, request, arg);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+uint32_t toLibyuvFourcc(uint32_t pixelFormat) {
+    switch (pixelFormat) {
+    case V4L2_PIX_FMT_YUV420:
+        return libyuv::FOURCC_I420;
+    case V4L2_PIX_FMT_NV12:
+        return libyuv::FOURCC_NV12;
+    case V4L2_PIX_FMT_YUYV:
+        return libyuv::FOURCC_YUY2;
+    case V4L2_PIX_FMT_UYVY:
+        return libyuv::FOURCC_UYVY;
+    case V4L2_PIX_FMT_MJPEG:
+        return libyuv::FOURCC_MJPG;
+    default:
+        return libyuv::FOURCC_ANY;
+    }
+}
+
+}  // namespace
+
+namespace vi {
+
+struct LinuxCapturer::Device {
+    struct Buffer {
+        void* start = MAP_FAILED;
+        size_t length = 0;
+        // Dequeued and referenced by a frame somewhere in the pipeline
+        bool held = false;
+    };
+
+    ~Device() {
+        for (const auto& buffer : buffers) {
+            if (buffer.start != MAP_FAILED) {
+                munmap(buffer.start, buffer.length);
+            }
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool StartStreaming() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t i = 0; i < buffers.size(); ++i) {
+            if (!buffers[i].held && !Queue(i)) {
+                return false;
+            }
+        }
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(fd, VIDIOC_STREAMON, &type) == -1) {
+            DLOG("VIDIOC_STREAMON failed: {}", strerror(errno));
+            return false;
+        }
+        streaming = true;
+        return true;
+    }
+
+    void StopStreaming() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!streaming) {
+            return;
+        }
+        streaming = false;
+        // Takes back every queued buffer, held ones stay with their frames
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd, VIDIOC_STREAMOFF, &type);
+    }
+
+    // Called when the last frame referencing |index| goes away, on whichever thread that is
+    void Release(uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers[index].held = false;
+        if (streaming) {
+            Queue(index);
+        }
+    }
+
+    bool Queue(uint32_t index) {
+        v4l2_buffer buffer = {};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = index;
+        if (xioctl(fd, VIDIOC_QBUF, &buffer) == -1) {
+            DLOG("VIDIOC_QBUF failed: {}", strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    int fd = -1;
+    uint32_t pixel_format = 0;
+    int width = 0;
+    int height = 0;
+    uint32_t bytes_per_line = 0;
+    std::vector<Buffer> buffers;
+
+    std::mutex mutex;
+    bool streaming = false;
+};
+
+LinuxCapturer::LinuxCapturer(size_t width,
+                             size_t height,
+                             size_t target_fps,
+                             size_t capture_device_index)
+    : width_(width),
+      height_(height),
+      target_fps_(target_fps > 0 ? target_fps : 30),
+      capture_device_index_(capture_device_index) {
+}
+
+LinuxCapturer* LinuxCapturer::Create(size_t width,
+                                     size_t height,
+                                     size_t target_fps,
+                                     size_t capture_device_index,
+                                     bool synthetic) {
+    LinuxCapturer* capturer = new LinuxCapturer(width, height, target_fps, capture_device_index);
+    if (synthetic || !capturer->OpenDevice()) {
+        ILOG("capture device {} is not used, generating a synthetic {}x{}@{} source",
+             capture_device_index, width, height, capturer->target_fps_);
+    }
+    return capturer;
+}
+
+LinuxCapturer::~LinuxCapturer() {
+    stop();
+}
+
+int LinuxCapturer::capture_width() const {
+    return device_ ? device_->width : (int)width_;
+}
+
+int LinuxCapturer::capture_height() const {
+    return device_ ? device_->height : (int)height_;
+}
+
+bool LinuxCapturer::OpenDevice() {
+    const std::string path = "/dev/video" + std::to_string(capture_device_index_);
+    auto device = std::make_shared<Device>();
+    device->fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (device->fd < 0) {
+        DLOG("cannot open {}: {}", path, strerror(errno));
+        return false;
+    }
+
+    v4l2_capability capability = {};
+    if (xioctl(device->fd, VIDIOC_QUERYCAP, &capability) == -1 ||
+        !(capability.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+        !(capability.capabilities & V4L2_CAP_STREAMING)) {
+        DLOG("{} does not support streaming capture", path);
+        return false;
+    }
+
+    uint32_t pixelFormat = 0;
+    size_t bestRank = sizeof(kPreferredFormats) / sizeof(kPreferredFormats[0]);
+    v4l2_fmtdesc description = {};
+    description.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    while (xioctl(device->fd, VIDIOC_ENUM_FMT, &description) == 0) {
+        for (size_t rank = 0; rank < bestRank; ++rank) {
+            if (description.pixelformat == kPreferredFormats[rank]) {
+                pixelFormat = description.pixelformat;
+                bestRank = rank;
+                break;
+            }
+        }
+        ++description.index;
+    }
+    if (pixelFormat == 0) {
+        DLOG("{} has no supported pixel format", path);
+        return false;
+    }
+
+    v4l2_format format = {};
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = (uint32_t)width_;
+    format.fmt.pix.height = (uint32_t)height_;
+    format.fmt.pix.pixelformat = pixelFormat;
+    format.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(device->fd, VIDIOC_S_FMT, &format) == -1) {
+        DLOG("VIDIOC_S_FMT failed: {}", strerror(errno));
+        return false;
+    }
+    // The driver picks the closest size it supports
+    device->pixel_format = format.fmt.pix.pixelformat;
+    device->width = (int)format.fmt.pix.width;
+    device->height = (int)format.fmt.pix.height;
+    device->bytes_per_line = format.fmt.pix.bytesperline;
+
+    v4l2_streamparm parameters = {};
+    parameters.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(device->fd, VIDIOC_G_PARM, &parameters) == 0 &&
+        (parameters.parm.capture.capability & V4L2_CAP_TIMEPERFRAME)) {
+        parameters.parm.capture.timeperframe.numerator = 1;
+        parameters.parm.capture.timeperframe.denominator = (uint32_t)target_fps_;
+        xioctl(device->fd, VIDIOC_S_PARM, &parameters);
+    }
+
+    v4l2_requestbuffers request = {};
+    request.count = kBufferCount;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(device->fd, VIDIOC_REQBUFS, &request) == -1 || request.count < 2) {
+        DLOG("{} cannot provide mmap buffers", path);
+        return false;
+    }
+
+    device->buffers.resize(request.count);
+    for (uint32_t i = 0; i < request.count; ++i) {
+        v4l2_buffer buffer = {};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = i;
+        if (xioctl(device->fd, VIDIOC_QUERYBUF, &buffer) == -1) {
+            DLOG("VIDIOC_QUERYBUF failed: {}", strerror(errno));
+            return false;
+        }
+        device->buffers[i].length = buffer.length;
+        device->buffers[i].start = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, device->fd, buffer.m.offset);
+        if (device->buffers[i].start == MAP_FAILED) {
+            DLOG("mmap failed: {}", strerror(errno));
+            return false;
+        }
+    }
+
+    ILOG("capturing from {}: {}x{}, fourcc {:08x}, {} buffers", path, device->width, device->height, device->pixel_format, request.count);
+    device_ = std::move(device);
+    return true;
+}
+
+void LinuxCapturer::start() {
+    if (running_) {
+        return;
+    }
+    if (device_ && !device_->StartStreaming()) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(device_ ? &LinuxCapturer::CaptureLoop : &LinuxCapturer::SyntheticLoop, this);
+}
+
+void LinuxCapturer::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (device_) {
+        device_->StopStreaming();
+    }
+}
+
+void LinuxCapturer::CaptureLoop() {
+    pollfd descriptor = {};
+    descriptor.fd = device_->fd;
+    descriptor.events = POLLIN;
+    while (running_) {
+        const int result = poll(&descriptor, 1, kPollTimeoutMs);
+        if (result < 0 && errno != EINTR) {
+            DLOG("poll failed: {}", strerror(errno));
+            break;
+        }
+        if (result > 0 && !ReadFrame()) {
+            break;
+        }
+    }
+}
+
+bool LinuxCapturer::ReadFrame() {
+    v4l2_buffer buffer = {};
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(device_->fd, VIDIOC_DQBUF, &buffer) == -1) {
+        if (errno == EAGAIN) {
+            return true;
+        }
+        DLOG("VIDIOC_DQBUF failed: {}", strerror(errno));
+        return false;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(device_->buffers[buffer.index].start);
+    const int width = device_->width;
+    const int height = device_->height;
+    const int64_t timestamp_us = rtc::TimeMicros();
+
+    rtc::scoped_refptr<VideoFrameBuffer> frameBuffer;
+    if (device_->pixel_format == V4L2_PIX_FMT_YUV420 && (buffer.flags & V4L2_BUF_FLAG_ERROR) == 0) {
+        // Hand the mmap'd planes over as they are, the driver gets the buffer back once every
+        // frame referencing it has been released
+        const int strideY = device_->bytes_per_line ? (int)device_->bytes_per_line : width;
+        const int strideUV = strideY / 2;
+        const uint8_t* dataU = data + strideY * height;
+        const uint8_t* dataV = dataU + strideUV * ((height + 1) / 2);
+        {
+            std::lock_guard<std::mutex> lock(device_->mutex);
+            device_->buffers[buffer.index].held = true;
+        }
+        std::shared_ptr<Device> device = device_;
+        const uint32_t index = buffer.index;
+        frameBuffer = WrapI420Buffer(width, height, data, strideY, dataU, strideUV, dataV, strideUV,
+                                     [device, index]() { device->Release(index); });
+    }
+    else {
+        rtc::scoped_refptr<I420Buffer> i420 = frame_pool_.CreateI420Buffer(width, height);
+        const int result = libyuv::ConvertToI420(data, buffer.bytesused,
+                                                 i420->MutableDataY(), i420->StrideY(),
+                                                 i420->MutableDataU(), i420->StrideU(),
+                                                 i420->MutableDataV(), i420->StrideV(),
+                                                 0, 0, width, height, width, height,
+                                                 libyuv::kRotate0, toLibyuvFourcc(device_->pixel_format));
+        {
+            std::lock_guard<std::mutex> lock(device_->mutex);
+            if (device_->streaming) {
+                device_->Queue(buffer.index);
+            }
+        }
+        if (result != 0) {
+            // Corrupt MJPEG frames are not unusual right after the stream starts
+            DLOG("dropping a frame that could not be converted");
+            return true;
+        }
+        frameBuffer = i420;
+    }
+
+    OnFrame(VideoFrame::Builder()
+            .set_video_frame_buffer(frameBuffer)
+            .set_rotation(kVideoRotation_0)
+            .set_timestamp_us(timestamp_us)
+            .build());
+    return true;
+}
+
+void LinuxCapturer::SyntheticLoop() {
+    // 75% color bars over a luma ramp that moves by a fixed step per frame
+    static const uint8_t kBars[][3] = {
+        { 180, 128, 128 }, { 168, 44, 136 }, { 145, 147, 44 }, { 133, 63, 52 },
+        { 63, 193, 204 }, { 51, 109, 212 }, { 28, 212, 120 }, { 16, 128, 128 },
+    };
+    const int barCount = sizeof(kBars) / sizeof(kBars[0]);
+
+    const int width = (int)width_;
+    const int height = (int)height_;
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    const int rampTop = height * 3 / 4;
+
+    const auto interval = std::chrono::microseconds(1000000 / target_fps_);
+    auto next = std::chrono::steady_clock::now();
+
+    while (running_) {
+        rtc::scoped_refptr<I420Buffer> buffer = frame_pool_.CreateI420Buffer(width, height);
+        const int shift = (int)(frame_number_ * 4);
+
+        for (int y = 0; y < height; ++y) {
+            uint8_t* row = buffer->MutableDataY() + y * buffer->StrideY();
+            if (y < rampTop) {
+                for (int bar = 0; bar < barCount; ++bar) {
+                    const int left = bar * width / barCount;
+                    const int right = (bar + 1) * width / barCount;
+                    memset(row + left, kBars[bar][0], right - left);
+                }
+            }
+            else {
+                for (int x = 0; x < width; ++x) {
+                    row[x] = (uint8_t)(16 + ((x + shift) % width) * 219 / width);
+                }
+            }
+        }
+        for (int y = 0; y < chromaHeight; ++y) {
+            uint8_t* rowU = buffer->MutableDataU() + y * buffer->StrideU();
+            uint8_t* rowV = buffer->MutableDataV() + y * buffer->StrideV();
+            if (y * 2 < rampTop) {
+                for (int bar = 0; bar < barCount; ++bar) {
+                    const int left = bar * chromaWidth / barCount;
+                    const int right = (bar + 1) * chromaWidth / barCount;
+                    memset(rowU + left, kBars[bar][1], right - left);
+                    memset(rowV + left, kBars[bar][2], right - left);
+                }
+            }
+            else {
+                memset(rowU, 128, chromaWidth);
+                memset(rowV, 128, chromaWidth);
+            }
+        }
+
+        OnFrame(VideoFrame::Builder()
+                .set_video_frame_buffer(buffer)
+                .set_rotation(kVideoRotation_0)
+                .set_timestamp_us(rtc::TimeMicros())
+                .build());
+        ++frame_number_;
+
+        next += interval;
+        const auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            // Fell behind, do not try to catch up with a burst
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+}  // namespace vi
@@ -0,0 +1,120 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "api/media_stream_interface.h"
+#include "api/scoped_refptr.h"
+#include "pc/video_track_source.h"
+#include "service/base_video_capturer.h"
+#include "service/capture_buffer_pool.h"
+#include "logger/spd_logger.h"
+
+namespace vi {
+using namespace webrtc;
+
+// Captures /dev/video<capture_device_index> through V4L2 streaming I/O with mmap'd buffers. I420
+// buffers are handed to the pipeline without a copy and go back to the driver when the last frame
+// referencing them is released, other formats are converted to I420. When there is no usable
+// device, or a synthetic source is asked for, a deterministic test pattern of the requested size
+// is generated at the target frame rate instead.
+class LinuxCapturer : public BaseVideoCapturer {
+public:
+    static LinuxCapturer* Create(size_t width,
+                                 size_t height,
+                                 size_t target_fps,
+                                 size_t capture_device_index,
+                                 bool synthetic = false);
+    ~LinuxCapturer() override;
+
+    void start();
+
+    void stop();
+
+    bool is_synthetic() const { return !device_; }
+
+    // Size of the delivered frames: what the driver settled on, or the requested one when synthetic
+    int capture_width() const;
+
+    int capture_height() const;
+
+private:
+    LinuxCapturer(size_t width,
+                  size_t height,
+                  size_t target_fps,
+                  size_t capture_device_index);
+
+    bool OpenDevice();
+
+    void CaptureLoop();
+
+    void SyntheticLoop();
+
+    bool ReadFrame();
+
+    struct Device;
+
+    size_t width_;
+    size_t height_;
+    size_t target_fps_;
+    size_t capture_device_index_;
+
+    // Shared with the release callbacks of zero-copy frames, which may outlive the capturer
+    std::shared_ptr<Device> device_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    // Drives the synthetic pattern, frame N always looks the same
+    uint32_t frame_number_ = 0;
+
+    // Converted and generated frames, only touched on the capture thread
+    CaptureBufferPool frame_pool_;
+};
+
+class LinuxTrackSource : public webrtc::VideoTrackSource {
+public:
+    LinuxTrackSource(std::unique_ptr<LinuxCapturer> video_capturer, bool is_screencast)
+        : VideoTrackSource(/*remote=*/false),
+          video_capturer_(std::move(video_capturer)),
+          is_screencast_(is_screencast) {}
+
+    ~LinuxTrackSource() { DLOG("~LinuxTrackSource()"); }
+
+    void start() {
+        video_capturer_->start();
+        SetState(kLive);
+    }
+
+    void stop() {
+        video_capturer_->stop();
+        SetState(kMuted);
+    }
+
+    bool is_screencast() const override { return is_screencast_; }
+
+    int capture_width() const { return video_capturer_->capture_width(); }
+
+    int capture_height() const { return video_capturer_->capture_height(); }
+
+protected:
+    rtc::VideoSourceInterface<VideoFrame>* source() override {
+        return video_capturer_.get();
+    }
+
+private:
+    std::unique_ptr<LinuxCapturer> video_capturer_;
+    const bool is_screencast_;
+};
+
+}
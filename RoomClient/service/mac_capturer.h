@@ -39,6 +39,11 @@ public:
 
     void stop();
 
+    // Size of the camera format picked for the requested one
+    int capture_width() const { return capture_width_; }
+
+    int capture_height() const { return capture_height_; }
+
 private:
     MacCapturer(size_t width,
                 size_t height,
@@ -50,6 +55,8 @@ private:
     size_t height_;
     size_t target_fps_;
     size_t capture_device_index_;
+    int capture_width_ = 0;
+    int capture_height_ = 0;
 
     void* capturer_;
     void* adapter_;
@@ -76,6 +83,10 @@ public:
 
     bool is_screencast() const override { return is_screencast_; }
 
+    int capture_width() const { return video_capturer_->capture_width(); }
+
+    int capture_height() const { return video_capturer_->capture_height(); }
+
 protected:
     rtc::VideoSourceInterface<VideoFrame>* source() override {
         return video_capturer_.get();
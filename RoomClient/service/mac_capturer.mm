@@ -74,6 +74,11 @@ MacCapturer::MacCapturer(size_t width,
     AVCaptureDevice *device =
         [[RTC_OBJC_TYPE(RTCCameraVideoCapturer) captureDevices] objectAtIndex:capture_device_index];
     AVCaptureDeviceFormat *format = SelectClosestFormat(device, width, height);
+    if (format) {
+        CMVideoDimensions dimension = CMVideoFormatDescriptionGetDimensions(format.formatDescription);
+        capture_width_ = dimension.width;
+        capture_height_ = dimension.height;
+    }
     [capturer startCaptureWithDevice:device format:format fps:target_fps];
 }
 
@@ -8,18 +8,46 @@
 *************************************************************************/
 
 #include <future>
+#include <algorithm>
 #include "media_controller.h"
 #include "Transport.hpp"
 #include "api/peer_connection_interface.h"
 #include "api/rtp_parameters.h"
+#include "api/rtp_sender_interface.h"
 #include "logger/spd_logger.h"
 #include "mediasoup_api.h"
+#include "json/json_bridge.hpp"
 //#include "windows_capture.h"
+#if defined(WEBRTC_LINUX)
+#include "linux_capturer.h"
+#else
 #include "mac_capturer.h"
+#endif
 #include "service/engine.h"
 #include "modules/audio_device/include/audio_device.h"
 #include "rtc_context.hpp"
 #include "rtc_base/thread.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+
+namespace {
+    // Requested camera capture format, the simulcast ladder follows what the camera actually delivers
+    const int32_t kCaptureWidth = 1280;
+    const int32_t kCaptureHeight = 720;
+    const int32_t kCaptureFps = 30;
+
+    // Decoded frames only switch resolution at the next key frame of the layer the SFU moved to
+    const int32_t kLayerSettleMs = 1000;
+
+    // "S3T3" / "L1T2" like mode of the consumer's encoding, empty when there is none
+    std::string scalabilityMode(const std::shared_ptr<mediasoupclient::Consumer>& consumer)
+    {
+        const auto& encodings = consumer->GetRtpParameters().value("encodings", nlohmann::json::array());
+        if (encodings.empty() || !encodings[0].contains("scalabilityMode") || !encodings[0]["scalabilityMode"].is_string()) {
+            return "";
+        }
+        return encodings[0]["scalabilityMode"].get<std::string>();
+    }
+}
 
 namespace vi {
 
@@ -44,7 +72,7 @@ namespace vi {
 
     void MediaController::init()
     {
-        configVideoEncodings();
+
     }
 
     void MediaController::destroy()
@@ -54,6 +82,8 @@ namespace vi {
             _micProducer = nullptr;
         }
 
+        ++_simulcastAdaptationGeneration;
+
         if (_camProducer) {
             _camProducer->Close();
             _camProducer = nullptr;
@@ -77,6 +107,13 @@ namespace vi {
             _capturerSource->stop();
             _capturerSource = nullptr;
         }
+
+        _consumerIdToPeerId.clear();
+        _consumerLayers.clear();
+        _visibilityTracking = false;
+        _visibleVideoPeers.clear();
+        _hiddenPauseTasks.clear();
+        _hiddenPausedConsumers.clear();
     }
 
     void MediaController::setMediasoupDevice(const std::shared_ptr<mediasoupclient::Device>& device)
@@ -96,7 +133,7 @@ namespace vi {
 
     void MediaController::addObserver(std::shared_ptr<IMediaEventHandler> observer, rtc::Thread* callbackThread)
     {
-        UniversalObservable<IMediaEventHandler>::addWeakObserver(observer, callbackThread);
+        UniversalObservable<IMediaEventHandler>::addWeakObserver(observer, callbackThread, ObserverDelivery::Batched);
     }
 
     void MediaController::removeObserver(std::shared_ptr<IMediaEventHandler> observer)
@@ -106,32 +143,15 @@ namespace vi {
 
     void MediaController::configVideoEncodings()
     {
-        _encodings.clear();
-
-        webrtc::RtpEncodingParameters ph;
-        ph.rid = "h";
-        ph.active = true;
-        ph.max_bitrate_bps = 1300 * 1000;
-        ph.scale_resolution_down_by = 1;
-        ph.scalability_mode = "L1T3";
-
-        webrtc::RtpEncodingParameters pm;
-        pm.rid = "m";
-        pm.active = true;
-        pm.max_bitrate_bps = 500 * 1000;
-        pm.scale_resolution_down_by = 2;
-        pm.scalability_mode = "L1T3";
-
-        webrtc::RtpEncodingParameters pl;
-        pl.rid = "l";
-        pl.active = true;
-        pl.max_bitrate_bps = 150 * 1000;
-        pl.scale_resolution_down_by = 4;
-        pl.scalability_mode = "L1T3";
-
-        _encodings.emplace_back(ph);
-        _encodings.emplace_back(pm);
-        _encodings.emplace_back(pl);
+        // Drivers round the requested size to a mode they support, the ladder is built for that one
+        int32_t width = _capturerSource ? _capturerSource->capture_width() : 0;
+        int32_t height = _capturerSource ? _capturerSource->capture_height() : 0;
+        if (width <= 0 || height <= 0) {
+            width = kCaptureWidth;
+            height = kCaptureHeight;
+        }
+        DLOG("simulcast ladder for a {}x{} capture", width, height);
+        _simulcastProfile.configure(width, height);
     }
 
     void MediaController::enableAudio(bool enabled)
@@ -334,8 +354,11 @@ namespace vi {
             if (!_capturerSource) {
 #ifdef WIN32
                 _capturerSource = WindowsCapturerTrackSource::Create(_signalingThread);
+#elif defined(WEBRTC_LINUX)
+                std::unique_ptr<LinuxCapturer> capturer = absl::WrapUnique(LinuxCapturer::Create(kCaptureWidth, kCaptureHeight, kCaptureFps, 0, _options->syntheticVideo.value_or(false)));
+                _capturerSource = rtc::make_ref_counted<LinuxTrackSource>(std::move(capturer), false);
 #else
-                std::unique_ptr<MacCapturer> capturer = absl::WrapUnique(MacCapturer::Create(1280, 720, 30, 0));
+                std::unique_ptr<MacCapturer> capturer = absl::WrapUnique(MacCapturer::Create(kCaptureWidth, kCaptureHeight, kCaptureFps, 0));
                 _capturerSource = rtc::make_ref_counted<MacTrackSource>(std::move(capturer), false);
 #endif
             }
@@ -357,14 +380,21 @@ namespace vi {
                     appData = sharingAppData;
                 }
 
+                // Every layer starts active, adaptation switches them off once the uplink is measured
+                configVideoEncodings();
+
                 mediasoupclient::Producer* producer = _sendTransport->Produce(this,
                                                                               track,
-                                                                              _options->useSimulcast.value_or(false) ? &_encodings : nullptr,
+                                                                              _options->useSimulcast.value_or(false) ? &_simulcastProfile.encodings() : nullptr,
                                                                               &codecOptions,
                                                                               nullptr,
                                                                               appData);
                 _camProducer.reset(producer);
 
+                if (_options->useSimulcast.value_or(false)) {
+                    scheduleSimulcastAdaptation(++_simulcastAdaptationGeneration);
+                }
+
                 UniversalObservable<IMediaEventHandler>::notifyObservers([wself = weak_from_this()](const auto& observer){
                     auto self = wself.lock();
                     if (!self) {
@@ -416,6 +446,7 @@ namespace vi {
                 observer->onRemoveLocalVideoTrack(self->_camProducer->GetId(), self->_camProducer->GetTrack());
             });
 
+            ++_simulcastAdaptationGeneration;
             _camProducer->Close();
             _camProducer = nullptr;
         }
@@ -469,6 +500,11 @@ namespace vi {
                     else {
                         consumer->Resume();
 
+                        // Stays paused on the SFU until the peer is rendered again
+                        if (_hiddenPausedConsumers.find(tid) != _hiddenPausedConsumers.end()) {
+                            continue;
+                        }
+
                         _mediasoupApi->resumeConsumer(consumer->GetId(), [wself = weak_from_this()](int32_t errorCode, const std::string& errorInfo, std::shared_ptr<signaling::BasicResponse> response){
                             auto self = wself.lock();
                             if (!self) {
@@ -665,8 +701,8 @@ namespace vi {
             return;
         }
 
-        nlohmann::json rtpParameters = nlohmann::json::parse(request->data->rtpParameters->toJsonStr());
-        nlohmann::json appData = nlohmann::json::parse(request->data->appData->toJsonStr());
+        nlohmann::json rtpParameters = toNlohmannJson(*request->data->rtpParameters);
+        nlohmann::json appData = toNlohmannJson(*request->data->appData);
         mediasoupclient::Consumer* consumer = _recvTransport->Consume(this,
                                                                       request->data->id.value(),
                                                                       request->data->producerId.value(),
@@ -680,6 +716,16 @@ namespace vi {
         _consumerIdToPeerId[request->data->id.value()] = request->data->peerId.value_or("");
         bool producerPaused = request->data->producerPaused.value();
 
+        if (ptr->GetKind() == "video") {
+            // Layer sizes are learnt from what is decoded, the probe only reads the frame size
+            auto& layers = _consumerLayers[ptr->GetId()];
+            layers.sizes.resize(spatialLayerCount(ptr));
+            layers.track = static_cast<webrtc::VideoTrackInterface*>(ptr->GetTrack());
+            layers.track->AddOrUpdateSink(&layers.probe, rtc::VideoSinkWants());
+        }
+
+        updateConsumerVisibility(request->data->id.value());
+
         UniversalObservable<IMediaEventHandler>::notifyObservers([wself = weak_from_this(), ptr, request, producerPaused](const auto& observer){
             auto self = wself.lock();
             if (!self) {
@@ -732,7 +778,7 @@ namespace vi {
             return;
         }
 
-        nlohmann::json appData = nlohmann::json::parse(request->data->appData->toJsonStr());
+        nlohmann::json appData = toNlohmannJson(*request->data->appData);
         mediasoupclient::DataConsumer* consumer = _recvTransport->ConsumeData(this,
                                                                               request->data->id.value(),
                                                                               request->data->dataProducerId.value(),
@@ -938,6 +984,9 @@ namespace vi {
                     }
                     consumer.second->Close();
                     self->_consumerIdToPeerId.erase(tid);
+                    self->_consumerLayers.erase(tid);
+                    self->_hiddenPauseTasks.erase(tid);
+                    self->_hiddenPausedConsumers.erase(tid);
                     self->_consumerMap.erase(tid);
                     return;
                 }
@@ -945,9 +994,278 @@ namespace vi {
         });
     }
 
+    int32_t MediaController::spatialLayerCount(const std::shared_ptr<mediasoupclient::Consumer>& consumer)
+    {
+        // Simulcast and SVC consumers carry "S3T3" / "L3T3" like scalability modes
+        const std::string mode = scalabilityMode(consumer);
+        if (mode.size() < 2 || (mode[0] != 'S' && mode[0] != 'L') || mode[1] < '1' || mode[1] > '9') {
+            return 1;
+        }
+        return mode[1] - '0';
+    }
+
+    int32_t MediaController::temporalLayerCount(const std::shared_ptr<mediasoupclient::Consumer>& consumer)
+    {
+        const std::string mode = scalabilityMode(consumer);
+        const size_t pos = mode.find('T');
+        if (pos == std::string::npos || pos + 1 >= mode.size() || mode[pos + 1] < '1' || mode[pos + 1] > '9') {
+            return 1;
+        }
+        return mode[pos + 1] - '0';
+    }
+
+    void MediaController::setPreferredVideoSize(const std::string& pid, int32_t width, int32_t height)
+    {
+        if (width <= 0 || height <= 0) {
+            return;
+        }
+
+        for (const auto& pair : _consumerIdToPeerId) {
+            if (pair.second != pid) {
+                continue;
+            }
+            auto it = _consumerLayers.find(pair.first);
+            if (it == _consumerLayers.end()) {
+                continue;
+            }
+            it->second.targetWidth = width;
+            it->second.targetHeight = height;
+            updatePreferredLayers(pair.first);
+        }
+    }
+
+    void MediaController::updateForwardedLayer(const std::string& tid, int32_t spatialLayer)
+    {
+        auto it = _consumerLayers.find(tid);
+        if (it == _consumerLayers.end()) {
+            return;
+        }
+
+        auto& layers = it->second;
+        layers.spatialLayer = spatialLayer;
+        const uint64_t generation = ++layers.generation;
+        if (spatialLayer < 0) {
+            return;
+        }
+
+        _mediasoupThread->PostDelayedTask(webrtc::ToQueuedTask([wself = weak_from_this(), tid, generation]() {
+            if (auto self = wself.lock()) {
+                self->measureLayerSize(tid, generation);
+            }
+        }), kLayerSettleMs);
+    }
+
+    void MediaController::measureLayerSize(const std::string& tid, uint64_t generation)
+    {
+        auto it = _consumerLayers.find(tid);
+        if (it == _consumerLayers.end() || it->second.generation != generation) {
+            return;
+        }
+
+        auto& layers = it->second;
+        if (layers.spatialLayer < 0 || layers.spatialLayer >= (int32_t)layers.sizes.size()) {
+            return;
+        }
+
+        int32_t width = 0;
+        int32_t height = 0;
+        if (!layers.probe.size(width, height)) {
+            return;
+        }
+
+        auto& size = layers.sizes[layers.spatialLayer];
+        if (size.first == width && size.second == height) {
+            return;
+        }
+        DLOG("consumer {} spatial layer {} is {}x{}", tid, layers.spatialLayer, width, height);
+        size = std::make_pair(width, height);
+
+        updatePreferredLayers(tid);
+    }
+
+    void MediaController::updatePreferredLayers(const std::string& tid)
+    {
+        if (!_mediasoupApi) {
+            DLOG("_mediasoupApi is null");
+            return;
+        }
+
+        auto consumer = _consumerMap.find(tid);
+        auto it = _consumerLayers.find(tid);
+        if (consumer == _consumerMap.end() || it == _consumerLayers.end()) {
+            return;
+        }
+
+        auto& layers = it->second;
+        const int32_t spatialLayers = (int32_t)layers.sizes.size();
+        if (spatialLayers <= 1 || layers.targetWidth <= 0 || layers.targetHeight <= 0) {
+            return;
+        }
+
+        // Lowest measured layer that covers the rendered area, the top one when none does
+        int32_t spatialLayer = spatialLayers - 1;
+        bool covered = false;
+        for (int32_t layer = 0; layer < spatialLayers; ++layer) {
+            const auto& size = layers.sizes[layer];
+            if (size.first >= layers.targetWidth && size.second >= layers.targetHeight) {
+                spatialLayer = layer;
+                covered = true;
+                break;
+            }
+        }
+
+        // Sizes are only known for layers forwarded once, the next lower one is tried to learn
+        // whether it is still large enough and is left again once measured if it is not
+        if (covered && spatialLayer > 0 && layers.sizes[spatialLayer - 1].first == 0) {
+            --spatialLayer;
+        }
+
+        if (layers.preferredSpatialLayer == spatialLayer) {
+            return;
+        }
+        layers.preferredSpatialLayer = spatialLayer;
+
+        const int32_t temporalLayer = temporalLayerCount(consumer->second) - 1;
+        _mediasoupApi->setConsumerPreferredLayers(tid, spatialLayer, temporalLayer, [](int32_t errorCode, const std::string& errorInfo, std::shared_ptr<signaling::BasicResponse> response){
+            if (errorCode != 0) {
+                DLOG("setConsumerPreferredLayers failed, error code: {}, error info: {}", errorCode, errorInfo);
+                return;
+            }
+            if (!response || !response->ok) {
+                DLOG("response is null or response->ok == false");
+                return;
+            }
+        });
+    }
+
+    void MediaController::setVisibleVideoPeers(const std::vector<std::string>& pids)
+    {
+        _visibilityTracking = true;
+        _visibleVideoPeers.clear();
+        _visibleVideoPeers.insert(pids.begin(), pids.end());
+
+        for (const auto& pair : _consumerIdToPeerId) {
+            updateConsumerVisibility(pair.first);
+        }
+    }
+
+    void MediaController::updateConsumerVisibility(const std::string& tid)
+    {
+        auto it = _consumerMap.find(tid);
+        if (it == _consumerMap.end() || it->second->GetKind() != "video") {
+            return;
+        }
+
+        if (!_mediasoupApi) {
+            DLOG("_mediasoupApi is null");
+            return;
+        }
+
+        auto consumer = it->second;
+        const bool visible = !_visibilityTracking || _visibleVideoPeers.find(_consumerIdToPeerId[tid]) != _visibleVideoPeers.end();
+
+        if (visible) {
+            // Showing up again is served at once, only hiding is delayed
+            _hiddenPauseTasks.erase(tid);
+            if (_hiddenPausedConsumers.erase(tid) == 0 || consumer->IsPaused()) {
+                return;
+            }
+
+            _mediasoupApi->resumeConsumer(tid, [wself = weak_from_this()](int32_t errorCode, const std::string& errorInfo, std::shared_ptr<signaling::BasicResponse> response){
+                auto self = wself.lock();
+                if (!self) {
+                    DLOG("RoomClient is null");
+                    return;
+                }
+                if (errorCode != 0) {
+                    DLOG("resumeConsumer failed, error code: {}, error info: {}", errorCode, errorInfo);
+                    return;
+                }
+                if (!response || !response->ok) {
+                    DLOG("response is null or response->ok == false");
+                    return;
+                }
+            });
+            return;
+        }
+
+        if (_hiddenPausedConsumers.find(tid) != _hiddenPausedConsumers.end() || _hiddenPauseTasks.find(tid) != _hiddenPauseTasks.end()) {
+            return;
+        }
+
+        // Layout changes flip tiles briefly, the pause only goes out if the peer stays hidden
+        const uint64_t generation = ++_hiddenPauseGeneration;
+        _hiddenPauseTasks[tid] = generation;
+        _mediasoupThread->PostDelayedTask(webrtc::ToQueuedTask([wself = weak_from_this(), tid, generation]() {
+            if (auto self = wself.lock()) {
+                self->pauseHiddenConsumer(tid, generation);
+            }
+        }), std::max<int32_t>(0, _options->hiddenVideoPauseDelay.value_or(0)));
+    }
+
+    void MediaController::pauseHiddenConsumer(const std::string& tid, uint64_t generation)
+    {
+        auto task = _hiddenPauseTasks.find(tid);
+        if (task == _hiddenPauseTasks.end() || task->second != generation) {
+            return;
+        }
+        _hiddenPauseTasks.erase(task);
+
+        auto it = _consumerMap.find(tid);
+        if (it == _consumerMap.end()) {
+            return;
+        }
+
+        if (!_mediasoupApi) {
+            DLOG("_mediasoupApi is null");
+            return;
+        }
+
+        _hiddenPausedConsumers.insert(tid);
+
+        // Muted consumers are already paused on the SFU
+        if (it->second->IsPaused()) {
+            return;
+        }
+
+        _mediasoupApi->pauseConsumer(tid, [wself = weak_from_this()](int32_t errorCode, const std::string& errorInfo, std::shared_ptr<signaling::BasicResponse> response){
+            auto self = wself.lock();
+            if (!self) {
+                DLOG("RoomClient is null");
+                return;
+            }
+            if (errorCode != 0) {
+                DLOG("pauseConsumer failed, error code: {}, error info: {}", errorCode, errorInfo);
+                return;
+            }
+            if (!response || !response->ok) {
+                DLOG("response is null or response->ok == false");
+                return;
+            }
+        });
+    }
+
     void MediaController::onConsumerLayersChanged(std::shared_ptr<signaling::ConsumerLayersChangedNotification> notification)
     {
+        if (!notification || !notification->data) {
+            return;
+        }
+
+        auto tid = notification->data->consumerId.value_or("");
+        if (tid.empty()) {
+            return;
+        }
 
+        // No spatial layer means nothing is forwarded at the moment
+        const int32_t spatialLayer = notification->data->spatialLayer.value_or(-1);
+        _mediasoupThread->PostTask([wself = weak_from_this(), tid, spatialLayer](){
+            auto self = wself.lock();
+            if (!self) {
+                DLOG("RoomClient is null");
+                return;
+            }
+            self->updateForwardedLayer(tid, spatialLayer);
+        });
     }
 
     void MediaController::onDataConsumerClosed(std::shared_ptr<signaling::DataConsumerClosedNotification> notification)
@@ -957,7 +1275,82 @@ namespace vi {
 
     void MediaController::onDownlinkBwe(std::shared_ptr<signaling::DownlinkBweNotification> notification)
     {
+        // The SFU's estimate for what it sends to us, the publish ladder follows the send
+        // transport's own estimate in adaptSimulcastLayers()
+        if (!notification || !notification->data) {
+            return;
+        }
+        DLOG("downlink bwe, available: {}, desired: {}, effective desired: {}",
+             notification->data->availableBitrate.value_or(0),
+             notification->data->desiredBitrate.value_or(0),
+             notification->data->effectiveDesiredBitrate.value_or(0));
+    }
+
+    void MediaController::scheduleSimulcastAdaptation(uint64_t generation)
+    {
+        const int32_t interval = _options->simulcastAdaptationInterval.value_or(0);
+        if (interval <= 0) {
+            return;
+        }
+        _mediasoupThread->PostDelayedTask(webrtc::ToQueuedTask([wself = weak_from_this(), generation]() {
+            if (auto self = wself.lock()) {
+                self->adaptSimulcastLayers(generation);
+            }
+        }), interval);
+    }
+
+    void MediaController::adaptSimulcastLayers(uint64_t generation)
+    {
+        // A newer producer or a closed one stops the old measurement loop
+        if (generation != _simulcastAdaptationGeneration) {
+            return;
+        }
+
+        if (!_camProducer || _camProducer->IsClosed() || !_sendTransport) {
+            return;
+        }
+
+        int64_t availableOutgoingBitrate = 0;
+        bool cpuLimited = false;
+        readUplinkStats(_sendTransport->GetStats(), availableOutgoingBitrate, cpuLimited);
+        if (_simulcastProfile.update(availableOutgoingBitrate, cpuLimited)) {
+            DLOG("{} of {} simulcast layers sustainable, available outgoing bitrate: {}, cpu limited: {}",
+                 _simulcastProfile.activeLayers(), _simulcastProfile.encodings().size(), availableOutgoingBitrate, cpuLimited);
+        }
+
+        // Compared against the sender every time, a failed SetParameters is retried next round
+        webrtc::RtpSenderInterface* sender = _camProducer->GetRtpSender();
+        if (sender) {
+            webrtc::RtpParameters parameters = sender->GetParameters();
+            if (_simulcastProfile.apply(parameters)) {
+                webrtc::RTCError error = sender->SetParameters(parameters);
+                if (!error.ok()) {
+                    DLOG("SetParameters failed: {}", error.message());
+                }
+            }
+        }
 
+        scheduleSimulcastAdaptation(generation);
+    }
+
+    void MediaController::readUplinkStats(const nlohmann::json& stats, int64_t& availableOutgoingBitrate, bool& cpuLimited)
+    {
+        if (!stats.is_array()) {
+            return;
+        }
+        for (const auto& report : stats) {
+            const std::string type = report.value("type", "");
+            if (type == "candidate-pair") {
+                if (report.value("nominated", false) && report.contains("availableOutgoingBitrate")) {
+                    availableOutgoingBitrate = std::max(availableOutgoingBitrate, (int64_t)report["availableOutgoingBitrate"].get<double>());
+                }
+            }
+            else if (type == "outbound-rtp") {
+                if (report.value("kind", "") == "video" && report.value("qualityLimitationReason", "") == "cpu") {
+                    cpuLimited = true;
+                }
+            }
+        }
     }
 
 }
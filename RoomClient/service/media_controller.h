@@ -10,6 +10,7 @@
 #pragma once
 
 #include <memory>
+#include <unordered_set>
 #include "i_media_controller.h"
 #include "i_media_event_handler.h"
 #include "i_signaling_event_handler.h"
@@ -21,6 +22,9 @@
 #include "options.h"
 #include "signaling_models.h"
 #include "Device.hpp"
+#include "simulcast_profile.h"
+#include "frame_size_probe.h"
+#include "api/media_stream_interface.h"
 
 namespace rtc {
     class Thread;
@@ -40,6 +44,7 @@ namespace vi {
 class IMediasoupApi;
 class WindowsCapturerTrackSource;
 class MacTrackSource;
+class LinuxTrackSource;
 
 class MediaController :
         public IMediaController,
@@ -94,6 +99,10 @@ public:
 
     bool isVideoMuted(const std::string& pid) override;
 
+    void setPreferredVideoSize(const std::string& pid, int32_t width, int32_t height) override;
+
+    void setVisibleVideoPeers(const std::vector<std::string>& pids) override;
+
     std::unordered_map<std::string, rtc::scoped_refptr<webrtc::MediaStreamTrackInterface>> getLocalVideoTracks() override;
 
     std::unordered_map<std::string, rtc::scoped_refptr<webrtc::MediaStreamTrackInterface>> getRemoteAudioTracks(const std::string& pid) override;
@@ -174,6 +183,27 @@ private:
 
      void updateConsumer(const std::string& tid, bool paused);
 
+     static int32_t spatialLayerCount(const std::shared_ptr<mediasoupclient::Consumer>& consumer);
+
+     static int32_t temporalLayerCount(const std::shared_ptr<mediasoupclient::Consumer>& consumer);
+
+     void updateForwardedLayer(const std::string& tid, int32_t spatialLayer);
+
+     void measureLayerSize(const std::string& tid, uint64_t generation);
+
+     void updatePreferredLayers(const std::string& tid);
+
+     void updateConsumerVisibility(const std::string& tid);
+
+     void pauseHiddenConsumer(const std::string& tid, uint64_t generation);
+
+     void scheduleSimulcastAdaptation(uint64_t generation);
+
+     void adaptSimulcastLayers(uint64_t generation);
+
+     // Largest estimate of the nominated candidate pairs and whether a video sender is CPU limited
+     static void readUplinkStats(const nlohmann::json& stats, int64_t& availableOutgoingBitrate, bool& cpuLimited);
+
 private:
      std::shared_ptr<Options> _options;
      rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> _peerConnectionFactory;
@@ -184,13 +214,18 @@ private:
      std::shared_ptr<mediasoupclient::SendTransport> _sendTransport;
      std::shared_ptr<mediasoupclient::RecvTransport> _recvTransport;
 
-     std::vector<webrtc::RtpEncodingParameters> _encodings;
+     SimulcastProfile _simulcastProfile;
+
+     // Bumped for every new or closed cam producer, only the current adaptation loop keeps running
+     uint64_t _simulcastAdaptationGeneration = 0;
 
      std::shared_ptr<mediasoupclient::Producer> _micProducer;
      std::shared_ptr<mediasoupclient::Producer> _camProducer;
 
 #ifdef WIN32
      rtc::scoped_refptr<WindowsCapturerTrackSource> _capturerSource;
+#elif defined(WEBRTC_LINUX)
+     rtc::scoped_refptr<LinuxTrackSource> _capturerSource;
 #else
           rtc::scoped_refptr<MacTrackSource> _capturerSource;
 #endif
@@ -203,6 +238,57 @@ private:
 
      // key: consumerId, value: peerId
      std::unordered_map<std::string, std::string> _consumerIdToPeerId;
+
+     // What is known about the spatial layers of a video consumer
+     struct ConsumerLayers {
+         ConsumerLayers() = default;
+
+         ConsumerLayers(const ConsumerLayers&) = delete;
+
+         ConsumerLayers& operator=(const ConsumerLayers&) = delete;
+
+         ~ConsumerLayers() {
+             if (track) {
+                 track->RemoveSink(&probe);
+             }
+         }
+
+         rtc::scoped_refptr<webrtc::VideoTrackInterface> track;
+
+         FrameSizeProbe probe;
+
+         // Decoded size of each spatial layer, 0 x 0 until the SFU forwarded it once
+         std::vector<std::pair<int32_t, int32_t>> sizes;
+
+         // Layer the SFU forwards as of the last layerschange, -1 for none
+         int32_t spatialLayer = -1;
+
+         // Bumped on every layerschange, a pending measurement of an older layer is dropped
+         uint64_t generation = 0;
+
+         // Letterboxed size the UI renders the video at, 0 x 0 until reported
+         int32_t targetWidth = 0;
+         int32_t targetHeight = 0;
+
+         // Last spatial layer requested through setConsumerPreferredLayers
+         int32_t preferredSpatialLayer = -1;
+     };
+
+     // key: consumerId, video consumers only
+     std::unordered_map<std::string, ConsumerLayers> _consumerLayers;
+
+     // Off-screen video is only tracked once the UI reported what it renders
+     bool _visibilityTracking = false;
+
+     std::unordered_set<std::string> _visibleVideoPeers;
+
+     // key: consumerId, value: generation of the pending delayed pause, resuming visibility cancels it
+     std::unordered_map<std::string, uint64_t> _hiddenPauseTasks;
+
+     uint64_t _hiddenPauseGeneration = 0;
+
+     // Consumers paused on the SFU because nobody renders them, the local consumer stays running
+     std::unordered_set<std::string> _hiddenPausedConsumers;
 };
 
 }
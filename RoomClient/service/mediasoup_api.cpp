@@ -219,7 +219,7 @@ namespace vi {
             return;
         }
 
-        sc->send(response->toJsonStr(), response->id.value_or(-1), nullptr, nullptr);
+        sc->send(response->toJsonStr(), response->id.value_or(-1), "", nullptr, nullptr);
     }
 
 }
@@ -92,12 +92,12 @@ private:
             return;
         }
 
-        sc->send(request->toJsonStr(), request->id.value_or(-1), [callback](const std::string& json){
+        sc->send(request->toJsonStr(), request->id.value_or(-1), request->method.value_or(""), [callback](absl::string_view json){
             if (json.empty()) {
                 return;
             }
             std::string err;
-            auto response = fromJsonString<Response>(json, err);
+            auto response = fromJsonStream<Response>(json, err);
             if (!err.empty()) {
                 DLOG("parse response failed: {}", err);
                 return;
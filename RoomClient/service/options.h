@@ -26,6 +26,14 @@ struct Options {
     absl::optional<bool> datachannel = true;
     absl::optional<std::string> throttleSecret;
     absl::optional<std::string> e2eKey;
+    // Window in ms over which score and volume notifications are coalesced, 0 disables it
+    absl::optional<int32_t> notificationCoalescingWindow = 200;
+    // Time in ms a peer's video must stay off-screen before its consumers are paused on the SFU
+    absl::optional<int32_t> hiddenVideoPauseDelay = 2000;
+    // Time in ms between uplink measurements that switch simulcast layers on and off, 0 keeps every layer on
+    absl::optional<int32_t> simulcastAdaptationInterval = 2000;
+    // Publish a generated test pattern instead of the camera, Linux only
+    absl::optional<bool> syntheticVideo;
 };
 
 }
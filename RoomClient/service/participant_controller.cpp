@@ -40,7 +40,7 @@ ParticipantController::ParticipantController(rtc::Thread* mediasoupThread, std::
 
     void ParticipantController::addObserver(std::shared_ptr<IParticipantEventHandler> observer, rtc::Thread* callbackThread)
     {
-        UniversalObservable<IParticipantEventHandler>::addWeakObserver(observer, callbackThread);
+        UniversalObservable<IParticipantEventHandler>::addWeakObserver(observer, callbackThread, ObserverDelivery::Batched);
     }
 
     void ParticipantController::removeObserver(std::shared_ptr<IParticipantEventHandler> observer)
@@ -82,6 +82,16 @@ ParticipantController::ParticipantController(rtc::Thread* mediasoupThread, std::
         return _mediaController->isVideoMuted(pid);
     }
 
+    void ParticipantController::setPreferredVideoSize(const std::string& pid, int32_t width, int32_t height)
+    {
+        _mediaController->setPreferredVideoSize(pid, width, height);
+    }
+
+    void ParticipantController::setVisibleVideoParticipants(const std::vector<std::string>& pids)
+    {
+        _mediaController->setVisibleVideoPeers(pids);
+    }
+
     void ParticipantController::createParticipant(const std::string& pid, const std::string& displayName)
     {
         if (_participantMap.find(pid) != _participantMap.end()) {
@@ -141,6 +151,16 @@ ParticipantController::ParticipantController(rtc::Thread* mediasoupThread, std::
         auto impl = std::dynamic_pointer_cast<Participant>(participant);
         impl->setActive(false);
 
+        {
+            // The peer leaves before a volume of it still pending could be delivered
+            std::lock_guard<std::mutex> locker(_volumeMutex);
+            auto it = _pendingVolumeIndex.find(pid);
+            if (it != _pendingVolumeIndex.end()) {
+                _pendingVolumes[it->second].participant = nullptr;
+                _pendingVolumeIndex.erase(it);
+            }
+        }
+
         UniversalObservable<IParticipantEventHandler>::notifyObservers([wself = weak_from_this(), participant](const auto& observer) {
             auto self = wself.lock();
             if (!self) {
@@ -208,12 +228,49 @@ ParticipantController::ParticipantController(rtc::Thread* mediasoupThread, std::
         //DLOG("ParticipantController: dBs = {}, volume = {}", dBs, volume);
         auto impl = std::dynamic_pointer_cast<Participant>(participant);
         impl->setSpeakingVolume(volume);
-        UniversalObservable<IParticipantEventHandler>::notifyObservers([wself = weak_from_this(), participant, volume](const auto& observer) {
+
+        // Volumes arriving in the same signaling batch reach observers in a single task
+        std::lock_guard<std::mutex> locker(_volumeMutex);
+        auto it = _pendingVolumeIndex.find(pid);
+        if (it != _pendingVolumeIndex.end()) {
+            _pendingVolumes[it->second].volume = volume;
+        }
+        else {
+            _pendingVolumeIndex[pid] = _pendingVolumes.size();
+            _pendingVolumes.push_back({ participant, volume });
+        }
+        if (!_volumeFlushPosted && _mediasoupThread) {
+            _volumeFlushPosted = true;
+            _mediasoupThread->PostTask([wself = weak_from_this()]() {
+                if (auto self = wself.lock()) {
+                    self->flushSpeakingVolumes();
+                }
+            });
+        }
+    }
+
+    void ParticipantController::flushSpeakingVolumes()
+    {
+        auto volumes = std::make_shared<std::vector<PendingVolume>>();
+        {
+            std::lock_guard<std::mutex> locker(_volumeMutex);
+            _volumeFlushPosted = false;
+            volumes->swap(_pendingVolumes);
+            _pendingVolumeIndex.clear();
+        }
+        if (volumes->empty()) {
+            return;
+        }
+        UniversalObservable<IParticipantEventHandler>::notifyObservers([wself = weak_from_this(), volumes](const auto& observer) {
             auto self = wself.lock();
             if (!self) {
                 return;
             }
-            observer->onRemoteActiveSpeaker(participant, volume);
+            for (const auto& pending : *volumes) {
+                if (pending.participant) {
+                    observer->onRemoteActiveSpeaker(pending.participant, pending.volume);
+                }
+            }
         });
     }
 
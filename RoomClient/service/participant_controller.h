@@ -10,6 +10,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "i_participant_controller.h"
 #include "i_media_event_handler.h"
 #include "utils/universal_observable.hpp"
@@ -61,6 +64,10 @@ namespace vi {
 
         bool isVideoMuted(const std::string& pid) override;
 
+        void setPreferredVideoSize(const std::string& pid, int32_t width, int32_t height) override;
+
+        void setVisibleVideoParticipants(const std::vector<std::string>& pids) override;
+
         void createParticipant(const std::string& pid, const std::string& displayName);
 
     protected:
@@ -120,6 +127,10 @@ namespace vi {
         void onCreateRemoteVideoTrack(const std::string& pid, const std::string& tid, rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track) override;
 
         void onRemoveRemoteVideoTrack(const std::string& pid, const std::string& tid, rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track) override;
+
+    private:
+        void flushSpeakingVolumes();
+
     private:
         rtc::Thread* _mediasoupThread;
 
@@ -127,6 +138,22 @@ namespace vi {
 
         // key: peer id
         std::unordered_map<std::string, std::shared_ptr<IParticipant>> _participantMap;
+
+        std::mutex _volumeMutex;
+
+        struct PendingVolume {
+            std::shared_ptr<IParticipant> participant;
+            int32_t volume;
+        };
+
+        // Latest volume per peer not yet delivered to observers, in order of first arrival. A peer
+        // that left keeps its slot with a null participant
+        std::vector<PendingVolume> _pendingVolumes;
+
+        // key: peer id, value: index into _pendingVolumes
+        std::unordered_map<std::string, size_t> _pendingVolumeIndex;
+
+        bool _volumeFlushPosted = false;
     };
 
 }
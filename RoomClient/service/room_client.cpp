@@ -16,6 +16,7 @@
 #include "utils/string_utils.h"
 #include "signaling_models.h"
 #include "json/serialization.hpp"
+#include "json/json_bridge.hpp"
 #include "PeerConnection.hpp"
 #include "api/peer_connection_interface.h"
 #include "api/media_stream_interface.h"
@@ -113,7 +114,7 @@ void RoomClient::destroy()
 
 void RoomClient::addObserver(std::shared_ptr<IRoomClientEventHandler> observer, rtc::Thread* callbackThread)
 {
-    UniversalObservable<IRoomClientEventHandler>::addWeakObserver(observer, callbackThread);
+    UniversalObservable<IRoomClientEventHandler>::addWeakObserver(observer, callbackThread, ObserverDelivery::Batched);
 }
 
 void RoomClient::removeObserver(std::shared_ptr<IRoomClientEventHandler> observer)
@@ -171,6 +172,7 @@ void RoomClient::join(const std::string& hostname, uint16_t port, const std::str
     _peerId = StringUtils::randomString(8);
 
     if (_signalingClient) {
+        _signalingClient->setCoalescingWindow((uint32_t)std::max<int32_t>(0, _options->notificationCoalescingWindow.value_or(0)));
         _signalingClient->disconnect();
         std::string url = getProtooUrl(_hostname, port, _roomId, _peerId);
         DLOG("protoo url: {}", url);
@@ -287,8 +289,7 @@ void RoomClient::getRouterRtpCapabilities()
 
 void RoomClient::onLoadMediasoupDevice(std::shared_ptr<signaling::GetRouterRtpCapabilitiesResponse> response)
 {
-    nlohmann::json rtpCapabilities = nlohmann::json::parse(response->data->toJsonStr());
-    DLOG("rtpCapabilities: {}", response->data->toJsonStr());
+    nlohmann::json rtpCapabilities = toNlohmannJson(*response->data);
     if (!_mediasoupDevice) {
         _mediasoupDevice = std::make_shared<mediasoupclient::Device>();
     }
@@ -327,14 +328,12 @@ void RoomClient::requestCreateTransport(bool forceTcp, bool producing, bool cons
     auto request = std::make_shared<signaling::CreateWebRtcTransportRequest>();
     request->data = signaling::CreateWebRtcTransportRequest::Data();
     if (_options->datachannel.value_or(false)) {
-        auto caps = _mediasoupDevice->GetSctpCapabilities();
-        std::string json(caps.dump().c_str());
-        DLOG("rtpCapabilities: {}", json);
-        if (json.empty()) {
+        const auto& caps = _mediasoupDevice->GetSctpCapabilities();
+        if (caps.is_null()) {
             return;
         }
         std::string err;
-        auto sctpCapabilities = fromJsonString<signaling::CreateWebRtcTransportRequest::SCTPCapabilities>(json, err);
+        auto sctpCapabilities = fromNlohmannJson<signaling::CreateWebRtcTransportRequest::SCTPCapabilities>(caps, err);
         if (!err.empty()) {
             DLOG("parse response failed: {}", err);
             return;
@@ -402,8 +401,7 @@ void RoomClient::createTransportImpl(bool producing, bool consuming, std::shared
         return;
     }
     DLOG("createTransportImpl, producing: {}, consuming: {}", producing, consuming);
-    nlohmann::json iceParameters = nlohmann::json::parse(transportInfo->data->iceParameters->toJsonStr());
-    DLOG("ice parameters: {}", iceParameters.dump());
+    nlohmann::json iceParameters = toNlohmannJson(*transportInfo->data->iceParameters);
     if (producing) {
         _sendTransportIceParameters = iceParameters;
     }
@@ -412,12 +410,11 @@ void RoomClient::createTransportImpl(bool producing, bool consuming, std::shared
     }
     nlohmann::json iceCandidates = nlohmann::json::array();
     for (auto& candidate : transportInfo->data->iceCandidates.value()) {
-        DLOG("candidate: {}", candidate.toJsonStr());
-        iceCandidates.emplace_back(nlohmann::json::parse(candidate.toJsonStr()));
+        iceCandidates.emplace_back(toNlohmannJson(candidate));
     }
     transportInfo->data->dtlsParameters->role = "auto";
-    nlohmann::json dtlsParameters = nlohmann::json::parse(transportInfo->data->dtlsParameters->toJsonStr());
-    nlohmann::json sctpParameters = nlohmann::json::parse(transportInfo->data->sctpParameters->toJsonStr());
+    nlohmann::json dtlsParameters = toNlohmannJson(*transportInfo->data->dtlsParameters);
+    nlohmann::json sctpParameters = toNlohmannJson(*transportInfo->data->sctpParameters);
 
     if (producing) {
         auto sendTransport = _mediasoupDevice->CreateSendTransport(this, transportInfo->data->id.value_or(""), iceParameters, iceCandidates, dtlsParameters, sctpParameters, _peerConnectionOptions.get());
@@ -447,14 +444,12 @@ void RoomClient::joinImpl()
     device.version = "3.4.2";
     request->data->device = device;
     if (_options->consume.value_or(false)) {
-        auto caps = _mediasoupDevice->GetRtpCapabilities();
-        std::string json(caps.dump().c_str());
-        DLOG("rtpCapabilities: {}", json);
-        if (json.empty()) {
+        const auto& caps = _mediasoupDevice->GetRtpCapabilities();
+        if (caps.is_null()) {
             return;
         }
         std::string err;
-        auto rtpCapabilities = fromJsonString<signaling::JoinRequest::RTPCapabilities>(json, err);
+        auto rtpCapabilities = fromNlohmannJson<signaling::JoinRequest::RTPCapabilities>(caps, err);
         if (!err.empty()) {
             DLOG("parse response failed: {}", err);
             return;
@@ -463,14 +458,12 @@ void RoomClient::joinImpl()
     }
 
     if (_options->datachannel.value_or(false)) {
-        auto caps = _mediasoupDevice->GetSctpCapabilities();
-        std::string json(caps.dump().c_str());
-        DLOG("rtpCapabilities: {}", json);
-        if (json.empty()) {
+        const auto& caps = _mediasoupDevice->GetSctpCapabilities();
+        if (caps.is_null()) {
             return;
         }
         std::string err;
-        auto sctpCapabilities = fromJsonString<signaling::JoinRequest::SCTPCapabilities>(json, err);
+        auto sctpCapabilities = fromNlohmannJson<signaling::JoinRequest::SCTPCapabilities>(caps, err);
         if (!err.empty()) {
             DLOG("parse response failed: {}", err);
             return;
@@ -665,20 +658,18 @@ void RoomClient::_onConnect(mediasoupclient::Transport* transport, const nlohman
     request->data = signaling::ConnectWebRtcTransportRequest::Data();
     request->data->transportId = transport->GetId();
 
-    nlohmann::json iceJson;
+    const nlohmann::json* iceJson = nullptr;
     if (_sendTransport && _sendTransport->GetId() == transport->GetId()) {
-        iceJson = _sendTransportIceParameters;
+        iceJson = &_sendTransportIceParameters;
     }
     else if (_recvTransport && _recvTransport->GetId() == transport->GetId()) {
-        iceJson = _recvTransportIceParameters;
+        iceJson = &_recvTransportIceParameters;
     }
-    std::string json(iceJson.dump().c_str());
-    DLOG("transport iceParameters: {}", json);
-    if (json.empty()) {
+    if (!iceJson || iceJson->is_null()) {
         return;
     }
     std::string err;
-    auto ice = fromJsonString<signaling::ConnectWebRtcTransportRequest::ICEParameters>(json, err);
+    auto ice = fromNlohmannJson<signaling::ConnectWebRtcTransportRequest::ICEParameters>(*iceJson, err);
     if (!err.empty()) {
         DLOG("parse response failed: {}", err);
         return;
@@ -686,13 +677,11 @@ void RoomClient::_onConnect(mediasoupclient::Transport* transport, const nlohman
 
     request->data->iceParameters = *ice;
 
-    json = dtlsParameters.dump().c_str();
-    DLOG("rtpCapabilities: {}", json);
-    if (json.empty()) {
+    if (dtlsParameters.is_null()) {
         return;
     }
     err.clear();
-    auto dtlsp = fromJsonString<signaling::ConnectWebRtcTransportRequest::DTLSParameters>(json, err);
+    auto dtlsp = fromNlohmannJson<signaling::ConnectWebRtcTransportRequest::DTLSParameters>(dtlsParameters, err);
     if (!err.empty()) {
         DLOG("parse response failed: {}", err);
         return;
@@ -747,13 +736,11 @@ std::string RoomClient::_onProduce(mediasoupclient::SendTransport* transport,
         request->data->appData->sharing = signaling::ProduceRequest::SharingData();
         request->data->appData->sharing->type = sharingAppData.sharing.type;
     }
-    std::string json(rtpParameters.dump().c_str());
-    DLOG("rtpCapabilities: {}", json);
-    if (json.empty()) {
+    if (rtpParameters.is_null()) {
         return "";
     }
     std::string err;
-    auto rtpp = fromJsonString<signaling::ProduceRequest::RTPParameters>(json, err);
+    auto rtpp = fromNlohmannJson<signaling::ProduceRequest::RTPParameters>(rtpParameters, err);
     if (!err.empty()) {
         DLOG("parse response failed: {}", err);
         return "";
@@ -801,13 +788,11 @@ std::string RoomClient::_onProduceData(mediasoupclient::SendTransport* transport
     request->data->transportId = transport->GetId();
     request->data->label = label;
     request->data->protocol = protocol;
-    std::string json(sctpStreamParameters.dump().c_str());
-    DLOG("rtpCapabilities: {}", json);
-    if (json.empty()) {
+    if (sctpStreamParameters.is_null()) {
         return "";
     }
     std::string err;
-    auto stcpsp = fromJsonString<signaling::ProduceDataRequest::SCTPStreamParameters>(json, err);
+    auto stcpsp = fromNlohmannJson<signaling::ProduceDataRequest::SCTPStreamParameters>(sctpStreamParameters, err);
     if (!err.empty()) {
         DLOG("parse response failed: {}", err);
         return "";
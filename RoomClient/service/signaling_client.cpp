@@ -13,9 +13,11 @@
 #include "signaling_models.h"
 #include "websocket/i_transport_observer.h"
 #include "websocket/websocket_request.h"
+#include "websocket/request_timer_wheel.h"
 #include "websocket/websocket_transport.h"
 #include "websocket/tls_websocket_endpoint.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/task_utils/to_queued_task.h"
 
 namespace vi {
 
@@ -23,6 +25,10 @@ SignalingClient::SignalingClient(rtc::Thread* thread)
     : _thread(thread)
 {
     _transport = std::make_shared<WebsocketTransport<TLSWebsocketEndpoint>>(_thread);
+
+    _timerWheel = std::make_shared<RequestTimerWheel>(_thread);
+
+    registerHandlers();
 }
 
 SignalingClient::~SignalingClient()
@@ -34,6 +40,11 @@ SignalingClient::~SignalingClient()
 void SignalingClient::init()
 {
     clearRequests();
+    _timerWheel->setTimeoutHandler([wself = weak_from_this()](int64_t id) {
+        if (auto self = wself.lock()) {
+            self->handleTimeout(id);
+        }
+    });
     _transport->init();
     _transport->addObserver(shared_from_this());
 }
@@ -65,7 +76,7 @@ void SignalingClient::disconnect()
     _transport->disconnect();
 }
 
-void SignalingClient::send(const std::string& text, int64_t transcation, SuccessCallback scb, FailureCallback fcb)
+void SignalingClient::send(const std::string& text, int64_t transcation, const std::string& method, SuccessCallback scb, FailureCallback fcb)
 {
     if (!text.empty()) {
         // Handle response sned directly
@@ -73,21 +84,18 @@ void SignalingClient::send(const std::string& text, int64_t transcation, Success
             _transport->send(text);
             return;
         }
-        uint32_t timeout = 1500 * (15 + (0.1 * _requestMap.size()));
+        uint32_t timeout = 1500 * (15 + (0.1 * _requests.size()));
         auto request = std::make_shared<vi::WebsocketRequest>(transcation, timeout);
+        request->setMethod(method);
         request->setText(text);
         request->setResolveCallback(scb);
         request->setRejectCallback(fcb);
-        {
-            std::lock_guard<std::mutex> locker(_requestMutex);
-            _requestMap[request->id()] = request;
-        }
+        addRequest(request);
         _transport->send(request->text());
-        request->ticktock();
     }
 }
 
-void SignalingClient::send(const std::vector<uint8_t>& data, int64_t transcation, SuccessCallback scb, FailureCallback fcb)
+void SignalingClient::send(const std::vector<uint8_t>& data, int64_t transcation, const std::string& method, SuccessCallback scb, FailureCallback fcb)
 {
     if (!data.empty()) {
         // Handle response sned directly
@@ -95,24 +103,80 @@ void SignalingClient::send(const std::vector<uint8_t>& data, int64_t transcation
             _transport->send(data);
             return;
         }
-        uint32_t timeout = 1500 * (15 + (0.1 * _requestMap.size()));
+        uint32_t timeout = 1500 * (15 + (0.1 * _requests.size()));
         auto request = std::make_shared<vi::WebsocketRequest>(transcation, timeout);
+        request->setMethod(method);
         request->setData(data);
         request->setResolveCallback(scb);
         request->setRejectCallback(fcb);
-        {
-            std::lock_guard<std::mutex> locker(_requestMutex);
-            _requestMap[request->id()] = request;
-        }
+        addRequest(request);
         _transport->send(request->data());
-        request->ticktock();
     }
 }
 
+std::vector<RequestLatencySnapshot> SignalingClient::requestLatencyStats()
+{
+    return _latencyStats.snapshot();
+}
+
+void SignalingClient::setCoalescingWindow(uint32_t milliseconds)
+{
+    _coalescingWindow = milliseconds;
+}
+
+void SignalingClient::scheduleCoalescedFlush()
+{
+    if (_flushScheduled || !_thread) {
+        return;
+    }
+    _flushScheduled = true;
+    _thread->PostDelayedTask(webrtc::ToQueuedTask([wself = weak_from_this()]() {
+        if (auto self = wself.lock()) {
+            self->flushCoalesced();
+        }
+    }), _coalescingWindow.load());
+}
+
+void SignalingClient::flushCoalesced()
+{
+    _flushScheduled = false;
+    if (_coalesced.empty()) {
+        return;
+    }
+
+    // One batched delivery per observer for the whole window
+    auto batch = std::make_shared<std::vector<std::pair<std::string, Delivery>>>();
+    batch->swap(_coalesced);
+    _coalescedIndex.clear();
+    UniversalObservable<ISignalingEventHandler>::notifyObservers([batch](const auto& observer) {
+        for (const auto& it : *batch) {
+            if (it.second) {
+                it.second(observer);
+            }
+        }
+    });
+}
+
+void SignalingClient::dropCoalesced(const std::string& key)
+{
+    auto it = _coalescedIndex.find(key);
+    if (it == _coalescedIndex.end()) {
+        return;
+    }
+    _coalesced[it->second].second = nullptr;
+    _coalescedIndex.erase(it);
+}
+
+void SignalingClient::addRequest(std::shared_ptr<WebsocketRequest> request)
+{
+    _requests.insert(request->id(), request);
+    _timerWheel->arm(request->id(), request->timeoutMs());
+}
+
 void SignalingClient::clearRequests()
 {
-    std::lock_guard<std::mutex> locker(_requestMutex);
-    _requestMap.clear();
+    _timerWheel->cancelAll();
+    _requests.clear();
 }
 
 void SignalingClient::onOpened()
@@ -124,13 +188,13 @@ void SignalingClient::onOpened()
 
 void SignalingClient::onClosed()
 {
-    std::lock_guard<std::mutex> locker(_requestMutex);
-    for (const auto& it : _requestMap) {
-        it.second->close();
+    _coalesced.clear();
+    _coalescedIndex.clear();
+    _timerWheel->cancelAll();
+    for (const auto& request : _requests.takeAll()) {
+        request->close();
     }
 
-    _requestMap.clear();
-
     UniversalObservable<ISignalingEventHandler>::notifyObservers([](const auto& observer){
         observer->onClosed();
     });
@@ -143,244 +207,173 @@ void SignalingClient::onFailed(int /*errorCode*/, const std::string& /*reason*/)
     });
 }
 
-void SignalingClient::onMessage(const std::string& json)
+void SignalingClient::onMessage(std::shared_ptr<InboundMessage> inbound)
 {
-    std::string err;
-    auto model = fromJsonString<signaling::MessageType>(json, err);
-    if (!err.empty()) {
-        DLOG("parse response failed: {}", err);
+    if (!inbound || inbound->empty()) {
         return;
     }
 
-    if (model->notification.value_or(false)) {
-        handleNotification(json);
+    // The document and every model parsed from it are done before the scope ends
+    rapidjson::JsonArenaScope scope;
+    rapidjson::ArenaDocument message(&scope.allocator(), scope.stackCapacity(), &scope.stackAllocator());
+    message.Parse(inbound->data(), inbound->size());
+    if (message.HasParseError() || !message.IsObject()) {
+        DLOG("parse message failed, size = {}", inbound->size());
+        return;
     }
-    else if (model->response.value_or(false)) {
-        handleResponse(json);
+
+    auto isTrue = [&message](const char* key) {
+        auto it = message.FindMember(key);
+        return it != message.MemberEnd() && it->value.IsBool() && it->value.GetBool();
+    };
+
+    if (isTrue("notification")) {
+        dispatch(_notificationHandlers, message);
+    }
+    else if (isTrue("response")) {
+        auto it = message.FindMember("id");
+        if (it != message.MemberEnd() && it->value.IsInt64()) {
+            handleResponse(inbound, it->value.GetInt64());
+        }
     }
-    else if (model->request.value_or(false)) {
-        handleRequest(json);
+    else if (isTrue("request")) {
+        dispatch(_requestHandlers, message);
     }
 }
 
-void SignalingClient::handleRequest(const std::string& json)
+template<typename Model>
+void SignalingClient::registerHandler(MessageHandlerMap& handlers, const std::string& method, void (ISignalingEventHandler::*callback)(std::shared_ptr<Model>))
 {
-    if (json.empty()) {
-        return;
-    }
+    handlers[method] = [this, callback](const rapidjson::Value& message) {
+        std::string err;
+        auto model = fromJsonValue<Model>(message, err);
+        if (!err.empty()) {
+            DLOG("parse response failed: {}", err);
+            return;
+        }
+        // All observers share the same model instance
+        UniversalObservable<ISignalingEventHandler>::notifyObservers([model, callback](const auto& observer) {
+            ((*observer).*callback)(model);
+        });
+    };
+}
 
-    std::string err;
-    auto header = fromJsonString<signaling::RequestHeader>(json, err);
-    if (!err.empty()) {
-        DLOG("parse response failed: {}", err);
-        return;
-    }
+template<typename Model>
+void SignalingClient::registerCoalescedHandler(const std::string& method, void (ISignalingEventHandler::*callback)(std::shared_ptr<Model>), std::function<std::string(const Model&)> key)
+{
+    _notificationHandlers[method] = [this, method, callback, key](const rapidjson::Value& message) {
+        std::string err;
+        auto model = fromJsonValue<Model>(message, err);
+        if (!err.empty()) {
+            DLOG("parse response failed: {}", err);
+            return;
+        }
+        auto delivery = [model, callback](const std::shared_ptr<ISignalingEventHandler>& observer) {
+            ((*observer).*callback)(model);
+        };
+        if (_coalescingWindow.load() == 0) {
+            UniversalObservable<ISignalingEventHandler>::notifyObservers(delivery);
+            return;
+        }
+        // A newer notification for the same id replaces the pending one and keeps its position
+        const std::string coalescedKey = method + ":" + key(*model);
+        auto it = _coalescedIndex.find(coalescedKey);
+        if (it != _coalescedIndex.end()) {
+            _coalesced[it->second].second = delivery;
+        }
+        else {
+            _coalescedIndex[coalescedKey] = _coalesced.size();
+            _coalesced.emplace_back(coalescedKey, delivery);
+        }
+        scheduleCoalescedFlush();
+    };
+}
 
-    auto method = header->method.value_or("");
+void SignalingClient::registerHandlers()
+{
+    // Request from SFU
+    registerHandler(_requestHandlers, "newConsumer", &ISignalingEventHandler::onNewConsumer);
+    registerHandler(_requestHandlers, "newDataConsumer", &ISignalingEventHandler::onNewDataConsumer);
 
-    if (method == "newConsumer") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer){
-            std::string err;
-            auto request = fromJsonString<signaling::NewConsumerRequest>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onNewConsumer(request);
-        });
-    }
-    else if (method == "newDataConsumer") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer){
-            std::string err;
-            auto request = fromJsonString<signaling::NewDataConsumerRequest>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onNewDataConsumer(request);
-        });
-    }
+    // Notification from SFU
+    registerCoalescedHandler<signaling::ProducerScoreNotification>("producerScore", &ISignalingEventHandler::onProducerScore, [](const auto& notification) {
+        return notification.data ? notification.data->producerId.value_or("") : std::string();
+    });
+    registerHandler(_notificationHandlers, "newPeer", &ISignalingEventHandler::onNewPeer);
+    registerHandler(_notificationHandlers, "peerClosed", &ISignalingEventHandler::onPeerClosed);
+    registerHandler(_notificationHandlers, "peerDisplayNameChanged", &ISignalingEventHandler::onPeerDisplayNameChanged);
+    registerHandler(_notificationHandlers, "downlinkBwe", &ISignalingEventHandler::onDownlinkBwe);
+    registerHandler(_notificationHandlers, "consumerClosed", &ISignalingEventHandler::onConsumerClosed);
+    registerHandler(_notificationHandlers, "consumerPaused", &ISignalingEventHandler::onConsumerPaused);
+    registerHandler(_notificationHandlers, "consumerResumed", &ISignalingEventHandler::onConsumerResumed);
+    registerHandler(_notificationHandlers, "consumerLayersChanged", &ISignalingEventHandler::onConsumerLayersChanged);
+    registerCoalescedHandler<signaling::ConsumerScoreNotification>("consumerScore", &ISignalingEventHandler::onConsumerScore, [](const auto& notification) {
+        return notification.data ? notification.data->consumerId.value_or("") : std::string();
+    });
+    registerHandler(_notificationHandlers, "dataConsumerClosed", &ISignalingEventHandler::onDataConsumerClosed);
+    registerCoalescedHandler<signaling::ActiveSpeakerNotification>("activeSpeaker", &ISignalingEventHandler::onActiveSpeaker, [](const auto& notification) {
+        return notification.data ? notification.data->peerId.value_or("") : std::string();
+    });
+
+    dropCoalescedOnClose("consumerClosed", "consumerId", "consumerScore");
+    dropCoalescedOnClose("peerClosed", "peerId", "activeSpeaker");
 }
 
-void SignalingClient::handleResponse(const std::string& json)
+void SignalingClient::dropCoalescedOnClose(const std::string& method, const char* idField, const std::string& coalescedMethod)
 {
-    if (_thread) {
-        _thread->PostTask([wself = weak_from_this(), json]() {
-            if (auto self = wself.lock()) {
-                std::string err;
-                auto header = fromJsonString<signaling::ResponseHeader>(json, err);
-                if (!err.empty()) {
-                    DLOG("parse response failed: {}", err);
-                    return;
-                }
-                if (header && header->id.value_or(-1) != -1)  {
-                    int64_t id = header->id.value();
-                    std::shared_ptr<WebsocketRequest> request;
-                    {
-                        std::lock_guard<std::mutex> locker(self->_requestMutex);
-                        if (self->_requestMap.find(id) != self->_requestMap.end()) {
-                            request = self->_requestMap[id];
-                            self->_requestMap.erase(id);
-                        }
-                    }
-                    if (request) {
-                        request->resolve(json);
-                    }
-                }
+    // A notification still pending for the closed consumer or peer would reach observers after its close
+    auto handler = _notificationHandlers[method];
+    _notificationHandlers[method] = [this, handler, idField, coalescedMethod](const rapidjson::Value& message) {
+        auto data = message.FindMember("data");
+        if (data != message.MemberEnd() && data->value.IsObject()) {
+            auto id = data->value.FindMember(idField);
+            if (id != data->value.MemberEnd() && id->value.IsString()) {
+                dropCoalesced(coalescedMethod + ":" + std::string(id->value.GetString(), id->value.GetStringLength()));
             }
-        });
-    }
+        }
+        handler(message);
+    };
 }
 
-void SignalingClient::handleNotification(const std::string& json)
+void SignalingClient::dispatch(const MessageHandlerMap& handlers, const rapidjson::Value& message)
 {
-    if (json.empty()) {
+    auto method = message.FindMember("method");
+    if (method == message.MemberEnd() || !method->value.IsString()) {
         return;
     }
 
-    std::string err;
-    auto header = fromJsonString<signaling::NotificationHeader>(json, err);
-    if (!err.empty()) {
-        DLOG("parse response failed: {}", err);
+    auto it = handlers.find(std::string(method->value.GetString(), method->value.GetStringLength()));
+    if (it == handlers.end()) {
         return;
     }
 
-    auto method = header->method.value_or("");
+    it->second(message);
+}
 
-    if (method == "producerScore") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ProducerScoreNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onProducerScore(notification);
-        });
-    }
-    else if (method == "newPeer") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::NewPeerNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onNewPeer(notification);
-        });
-    }
-    else if (method == "peerClosed") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::PeerClosedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onPeerClosed(notification);
-        });
-    }
-    else if (method == "peerDisplayNameChanged") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::PeerDisplayNameChangedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onPeerDisplayNameChanged(notification);
-        });
-    }
-    else if (method == "downlinkBwe") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::DownlinkBweNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onDownlinkBwe(notification);
-        });
-    }
-    else if (method == "consumerClosed") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ConsumerClosedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onConsumerClosed(notification);
-        });
-    }
-    else if (method == "consumerPaused") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ConsumerPausedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onConsumerPaused(notification);
-        });
-    }
-    else if (method == "consumerResumed") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ConsumerResumedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onConsumerResumed(notification);
-        });
-    }
-    else if (method == "consumerLayersChanged") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ConsumerLayersChangedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onConsumerLayersChanged(notification);
-        });
-    }
-    else if (method == "consumerScore") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ConsumerScoreNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onConsumerScore(notification);
-        });
-    }
-    else if (method == "dataConsumerClosed") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::DataConsumerClosedNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
-            }
-            observer->onDataConsumerClosed(notification);
-        });
-    }
-    else if (method == "activeSpeaker") {
-        UniversalObservable<ISignalingEventHandler>::notifyObservers([json](const auto& observer) {
-            std::string err;
-            auto notification = fromJsonString<signaling::ActiveSpeakerNotification>(json, err);
-            if (!err.empty()) {
-                DLOG("parse response failed: {}", err);
-                return;
+void SignalingClient::handleResponse(std::shared_ptr<InboundMessage> message, int64_t id)
+{
+    if (_thread) {
+        _thread->PostTask([wself = weak_from_this(), message, id]() {
+            if (auto self = wself.lock()) {
+                auto request = self->_requests.take(id);
+                if (request) {
+                    self->_timerWheel->cancel(id);
+                    self->_latencyStats.record(request->method(), request->elapsedMs());
+                    request->resolve(message->payload());
+                }
             }
-            observer->onActiveSpeaker(notification);
         });
     }
 }
 
+void SignalingClient::handleTimeout(int64_t id)
+{
+    auto request = _requests.take(id);
+    if (request) {
+        DLOG("request timeout, id = {}, method = {}", id, request->method());
+        _latencyStats.recordTimeout(request->method());
+        request->timeout();
+    }
 }
 
-
+}
@@ -10,12 +10,18 @@
 #pragma once
 
 #include <memory>
-#include <mutex>
+#include <atomic>
+#include <functional>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include <rapidjson/document.h>
 #include "i_signaling_client.h"
 #include "websocket/i_transport_observer.h"
 #include "utils/universal_observable.hpp"
 #include "i_signaling_event_handler.h"
+#include "websocket/pending_request_table.h"
+#include "websocket/request_latency_stats.h"
 
 namespace rtc {
     class Thread;
@@ -25,6 +31,7 @@ namespace vi {
 
 class WebsocketRequest;
 class ITransport;
+class RequestTimerWheel;
 
 class SignalingClient : public ISignalingClient, public ITransportObserver, public UniversalObservable<ISignalingEventHandler>, public std::enable_shared_from_this<SignalingClient>
 {
@@ -45,9 +52,13 @@ public:
 
     void disconnect() override;
 
-    void send(const std::string& text, int64_t transcation, SuccessCallback scb, FailureCallback fcb) override;
+    void send(const std::string& text, int64_t transcation, const std::string& method, SuccessCallback scb, FailureCallback fcb) override;
 
-    void send(const std::vector<uint8_t>& data, int64_t transcation, SuccessCallback scb, FailureCallback fcb) override;
+    void send(const std::vector<uint8_t>& data, int64_t transcation, const std::string& method, SuccessCallback scb, FailureCallback fcb) override;
+
+    std::vector<RequestLatencySnapshot> requestLatencyStats() override;
+
+    void setCoalescingWindow(uint32_t milliseconds) override;
 
 protected:
     void onOpened() override;
@@ -56,14 +67,40 @@ protected:
 
     void onFailed(int errorCode, const std::string& reason) override;
 
-    void onMessage(const std::string& json) override;
+    void onMessage(std::shared_ptr<InboundMessage> message) override;
 
 private:
-    void handleRequest(const std::string& json);
+    // Invoked with the already parsed protoo message, deserializes the typed model once
+    using MessageHandler = std::function<void(const rapidjson::Value& message)>;
+
+    using MessageHandlerMap = std::unordered_map<std::string, MessageHandler>;
+
+    void registerHandlers();
+
+    template<typename Model>
+    void registerHandler(MessageHandlerMap& handlers, const std::string& method, void (ISignalingEventHandler::*callback)(std::shared_ptr<Model>));
+
+    template<typename Model>
+    void registerCoalescedHandler(const std::string& method, void (ISignalingEventHandler::*callback)(std::shared_ptr<Model>), std::function<std::string(const Model&)> key);
+
+    void dispatch(const MessageHandlerMap& handlers, const rapidjson::Value& message);
+
+    void scheduleCoalescedFlush();
+
+    void flushCoalesced();
+
+    // Forgets the pending delivery of |key|, e.g. the score of a consumer that was just closed
+    void dropCoalesced(const std::string& key);
 
-    void handleResponse(const std::string& json);
+    // Wraps the handler of |method| so that it first drops the pending |coalescedMethod| delivery
+    // keyed by the notification's data.|idField|
+    void dropCoalescedOnClose(const std::string& method, const char* idField, const std::string& coalescedMethod);
 
-    void handleNotification(const std::string& json);
+    void handleResponse(std::shared_ptr<InboundMessage> message, int64_t id);
+
+    void handleTimeout(int64_t id);
+
+    void addRequest(std::shared_ptr<WebsocketRequest> request);
 
     void clearRequests();
 
@@ -72,9 +109,28 @@ private:
 
     std::shared_ptr<ITransport> _transport;
 
-    std::mutex _requestMutex;
+    PendingRequestTable _requests;
+
+    RequestLatencyStats _latencyStats;
+
+    std::shared_ptr<RequestTimerWheel> _timerWheel;
+
+    MessageHandlerMap _requestHandlers;
+
+    MessageHandlerMap _notificationHandlers;
+
+    using Delivery = std::function<void(const std::shared_ptr<ISignalingEventHandler>& observer)>;
+
+    std::atomic<uint32_t> _coalescingWindow{ 0 };
+
+    // Only touched on _thread. Latest delivery per method + id in order of first arrival, a dropped
+    // entry keeps its slot with an empty delivery
+    std::vector<std::pair<std::string, Delivery>> _coalesced;
+
+    // key: method + id, value: index into _coalesced
+    std::unordered_map<std::string, size_t> _coalescedIndex;
 
-    std::unordered_map<int64_t, std::shared_ptr<WebsocketRequest>> _requestMap;
+    bool _flushScheduled = false;
 };
 
 }
@@ -0,0 +1,137 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "simulcast_profile.h"
+#include <algorithm>
+
+namespace {
+
+    struct LayerProfile {
+        const char* rid;
+        double scaleDownBy;
+        int32_t maxBitrateKbps;
+    };
+
+    struct LadderProfile {
+        // Smallest capture height the ladder is meant for
+        int32_t minHeight;
+        const char* scalabilityMode;
+        std::vector<LayerProfile> layers;
+    };
+
+    // Highest layer first, a lower layer must stay at least 180p to be worth sending
+    const LadderProfile kLadders[] = {
+        { 1080, "L1T3", { { "h", 1, 2500 }, { "m", 2, 800 }, { "l", 4, 250 } } },
+        { 720, "L1T3", { { "h", 1, 1300 }, { "m", 2, 500 }, { "l", 4, 150 } } },
+        { 360, "L1T3", { { "h", 1, 500 }, { "l", 2, 150 } } },
+        { 0, "L1T2", { { "h", 1, 300 } } },
+    };
+
+    // A layer only comes back once the uplink has this much room above its bitrate, so that a
+    // marginal estimate does not toggle it on every measurement
+    const double kUpgradeHeadroom = 1.25;
+
+    // Measurements in a row the encoder must be CPU limited before a layer is shed for it
+    const int32_t kCpuLimitedSamples = 2;
+}
+
+namespace vi {
+
+    void SimulcastProfile::configure(int32_t width, int32_t height)
+    {
+        // Portrait captures are judged by their short side too
+        const int32_t shortSide = std::min(width, height);
+
+        const LadderProfile* ladder = &kLadders[sizeof(kLadders) / sizeof(kLadders[0]) - 1];
+        for (const auto& profile : kLadders) {
+            if (shortSide >= profile.minHeight) {
+                ladder = &profile;
+                break;
+            }
+        }
+
+        _encodings.clear();
+        for (const auto& layer : ladder->layers) {
+            webrtc::RtpEncodingParameters encoding;
+            encoding.rid = layer.rid;
+            encoding.active = true;
+            encoding.max_bitrate_bps = layer.maxBitrateKbps * 1000;
+            encoding.scale_resolution_down_by = layer.scaleDownBy;
+            encoding.scalability_mode = ladder->scalabilityMode;
+            _encodings.emplace_back(encoding);
+        }
+        _activeLayers = _encodings.size();
+        _cpuLimitedSamples = 0;
+    }
+
+    bool SimulcastProfile::update(int64_t availableOutgoingBitrate, bool cpuLimited)
+    {
+        if (_encodings.empty()) {
+            return false;
+        }
+
+        _cpuLimitedSamples = cpuLimited ? _cpuLimitedSamples + 1 : 0;
+
+        size_t target = _activeLayers;
+        if (availableOutgoingBitrate > 0) {
+            target = 1;
+            for (size_t layers = 2; layers <= _encodings.size(); ++layers) {
+                const double headroom = layers > _activeLayers ? kUpgradeHeadroom : 1.0;
+                if (requiredBitrate(layers) * headroom > availableOutgoingBitrate) {
+                    break;
+                }
+                target = layers;
+            }
+            // Climb back one layer per measurement, the estimate catches up with the added load
+            target = std::min(target, _activeLayers + 1);
+        }
+
+        if (_cpuLimitedSamples >= kCpuLimitedSamples) {
+            target = std::min(target, _activeLayers > 1 ? _activeLayers - 1 : 1);
+            _cpuLimitedSamples = 0;
+        }
+
+        if (target == _activeLayers) {
+            return false;
+        }
+        _activeLayers = target;
+        return true;
+    }
+
+    bool SimulcastProfile::apply(webrtc::RtpParameters& parameters) const
+    {
+        bool changed = false;
+        for (auto& encoding : parameters.encodings) {
+            auto it = std::find_if(_encodings.begin(), _encodings.end(), [&encoding](const webrtc::RtpEncodingParameters& profile) {
+                return profile.rid == encoding.rid;
+            });
+            if (encoding.rid.empty() || it == _encodings.end()) {
+                continue;
+            }
+            // The lowest |_activeLayers| layers are on, they sit at the end of the ladder
+            const size_t index = it - _encodings.begin();
+            const bool active = index >= _encodings.size() - _activeLayers;
+            if (encoding.active != active) {
+                encoding.active = active;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    int64_t SimulcastProfile::requiredBitrate(size_t layers) const
+    {
+        int64_t bitrate = 0;
+        for (size_t i = _encodings.size() - layers; i < _encodings.size(); ++i) {
+            bitrate += _encodings[i].max_bitrate_bps.value_or(0);
+        }
+        return bitrate;
+    }
+
+}
@@ -0,0 +1,55 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "api/rtp_parameters.h"
+
+namespace vi {
+
+    // Chooses the simulcast ladder (layer count, bitrates, scalability mode) for a capture size and
+    // keeps only as many of its layers active as the measured uplink and CPU can sustain. Layers are
+    // dropped from the top, the lowest one always stays on.
+    class SimulcastProfile
+    {
+    public:
+        SimulcastProfile() = default;
+
+        // Rebuilds the ladder for a capture of |width| x |height| with every layer active
+        void configure(int32_t width, int32_t height);
+
+        // Highest layer first, as handed to SendTransport::Produce()
+        const std::vector<webrtc::RtpEncodingParameters>& encodings() const { return _encodings; }
+
+        size_t activeLayers() const { return _activeLayers; }
+
+        // Feeds one uplink measurement, returns true when the number of active layers changed.
+        // |availableOutgoingBitrate| <= 0 means no estimate yet and keeps the current layers.
+        bool update(int64_t availableOutgoingBitrate, bool cpuLimited);
+
+        // Sets the active flags of the sender's encodings, matched by rid. Returns true when
+        // anything changed and the parameters need to be set on the sender.
+        bool apply(webrtc::RtpParameters& parameters) const;
+
+    private:
+        // Bitrate of the lowest |layers| layers together
+        int64_t requiredBitrate(size_t layers) const;
+
+    private:
+        std::vector<webrtc::RtpEncodingParameters> _encodings;
+
+        size_t _activeLayers = 0;
+
+        // Consecutive measurements in which the encoder reported being CPU limited
+        int32_t _cpuLimitedSamples = 0;
+    };
+
+}
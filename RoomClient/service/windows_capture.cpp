@@ -21,66 +21,22 @@ namespace vi {
 	SimpleVideoCapturer::~SimpleVideoCapturer() = default;
 
 	void SimpleVideoCapturer::OnFrame(const VideoFrame & original_frame) {
-		int cropped_width = 0;
-		int cropped_height = 0;
-		int out_width = 0;
-		int out_height = 0;
-
-		VideoFrame frame = MaybePreprocess(original_frame);
-
-		if (!video_adapter_.AdaptFrameResolution(
-			frame.width(), frame.height(), frame.timestamp_us() * 1000,
-			&cropped_width, &cropped_height, &out_width, &out_height)) {
-			// Drop frame in order to respect frame rate constraint.
-			return;
-		}
-
-		if (out_height != frame.height() || out_width != frame.width()) {
-			// Video adapter has requested a down-scale. Allocate a new buffer and
-			// return scaled version.
-			// For simplicity, only scale here without cropping.
-			rtc::scoped_refptr<I420Buffer> scaled_buffer =
-				I420Buffer::Create(out_width, out_height);
-			scaled_buffer->ScaleFrom(*frame.video_frame_buffer()->ToI420());
-			VideoFrame::Builder new_frame_builder =
-				VideoFrame::Builder()
-				.set_video_frame_buffer(scaled_buffer)
-				.set_rotation(kVideoRotation_0)
-				.set_timestamp_us(frame.timestamp_us())
-				.set_id(frame.id());
-			if (frame.has_update_rect()) {
-				VideoFrame::UpdateRect new_rect = frame.update_rect().ScaleWithFrame(
-					frame.width(), frame.height(), 0, 0, frame.width(), frame.height(),
-					out_width, out_height);
-				new_frame_builder.set_update_rect(new_rect);
-			}
-			broadcaster_.OnFrame(new_frame_builder.build());
-
-		}
-		else {
-			// No adaptations needed, just return the frame as is.
-			broadcaster_.OnFrame(frame);
-		}
+		// Every sink gets the frame adapted to its own wants, see FrameFanout
+		fanout_.OnFrame(MaybePreprocess(original_frame));
 	}
 
 	rtc::VideoSinkWants SimpleVideoCapturer::GetSinkWants() {
-		return broadcaster_.wants();
+		return fanout_.wants();
 	}
 
 	void SimpleVideoCapturer::AddOrUpdateSink(
 		rtc::VideoSinkInterface<VideoFrame>*sink,
 		const rtc::VideoSinkWants & wants) {
-		broadcaster_.AddOrUpdateSink(sink, wants);
-		UpdateVideoAdapter();
+		fanout_.AddOrUpdateSink(sink, wants);
 	}
 
 	void SimpleVideoCapturer::RemoveSink(rtc::VideoSinkInterface<VideoFrame>*sink) {
-		broadcaster_.RemoveSink(sink);
-		UpdateVideoAdapter();
-	}
-
-	void SimpleVideoCapturer::UpdateVideoAdapter() {
-		video_adapter_.OnSinkWants(broadcaster_.wants());
+		fanout_.RemoveSink(sink);
 	}
 
 	VideoFrame SimpleVideoCapturer::MaybePreprocess(const VideoFrame & frame) {
@@ -130,6 +86,10 @@ namespace vi {
 		capability_.maxFPS = static_cast<int32_t>(target_fps);
 		capability_.videoType = VideoType::kI420;
 
+		if (device_info->GetBestMatchedCapability(vcm_->CurrentDeviceName(), capability_, matched_) < 0) {
+			matched_ = capability_;
+		}
+
 		if (thread_->BlockingCall(std::bind(&VcmCapturer::_startCapture, this)) != 0) {
 			Destroy();
 			return false;
@@ -20,6 +20,7 @@
 #include "media/base/video_broadcaster.h"
 #include "rtc_base/thread.h"
 #include "capturer_track_source.hpp"
+#include "frame_fanout.h"
 namespace vi {
 
 	using namespace webrtc;
@@ -42,6 +43,11 @@ namespace vi {
 			preprocessor_ = std::move(preprocessor);
 		}
 
+		// Reuse of the buffers adapted frames are scaled into
+		CaptureBufferPool::Stats GetScalePoolStats() const {
+			return fanout_.GetPoolStats();
+		}
+
 		void OnFrame(const VideoFrame& frame);
 
 	protected:
@@ -49,13 +55,11 @@ namespace vi {
 		rtc::VideoSinkWants GetSinkWants();
 
 	private:
-		void UpdateVideoAdapter();
 		VideoFrame MaybePreprocess(const VideoFrame& frame);
 
 		Mutex lock_;
 		std::unique_ptr<FramePreprocessor> preprocessor_ RTC_GUARDED_BY(lock_);
-		rtc::VideoBroadcaster broadcaster_;
-		cricket::VideoAdapter video_adapter_;
+		FrameFanout fanout_;
 	};
 
 	class VcmCapturer {
@@ -70,6 +74,11 @@ namespace vi {
 
 		int32_t stop();
 
+		// Mode the capture module settles on for the requested capability
+		int32_t capture_width() const { return matched_.width; }
+
+		int32_t capture_height() const { return matched_.height; }
+
 	private:
 		VcmCapturer(rtc::Thread* thread);
 		bool Init(size_t width,
@@ -89,6 +98,7 @@ namespace vi {
 	private:
 		rtc::scoped_refptr<VideoCaptureModule> vcm_;
 		VideoCaptureCapability capability_;
+		VideoCaptureCapability matched_;
 		rtc::Thread* thread_;
 	};
 
@@ -176,6 +186,14 @@ namespace vi {
 			return m_captureing;
 		}
 
+		int32_t capture_width() const {
+			return capturer_ ? capturer_->capture_width() : 0;
+		}
+
+		int32_t capture_height() const {
+			return capturer_ ? capturer_->capture_height() : 0;
+		}
+
 		void OnFrame(const VideoFrame& frame) {
 			_videoCapturer->OnFrame(frame);
 		}
@@ -0,0 +1,106 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "thread_dispatch_queue.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include "concurrentqueue/concurrentqueue.h"
+#include "rtc_base/thread.h"
+
+namespace vi {
+
+namespace {
+
+// Tasks run per dequeue, bounds the stack buffer not the drain itself
+constexpr size_t kDrainBatchSize = 32;
+
+class ThreadDispatchQueueImpl : public ThreadDispatchQueue, public std::enable_shared_from_this<ThreadDispatchQueueImpl>
+{
+public:
+    explicit ThreadDispatchQueueImpl(rtc::Thread* thread)
+        : _thread(thread)
+    {
+
+    }
+
+    rtc::Thread* thread() const override
+    {
+        return _thread;
+    }
+
+    void post(std::function<void()> task) override
+    {
+        _queue.enqueue(std::move(task));
+        _pending.fetch_add(1, std::memory_order_relaxed);
+        if (_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        _thread->PostTask([wself = weak_from_this()]() {
+            if (auto self = wself.lock()) {
+                self->drain();
+            }
+        });
+    }
+
+    size_t pending() const override
+    {
+        return _pending.load(std::memory_order_relaxed);
+    }
+
+private:
+    void drain()
+    {
+        // Cleared before dequeuing: a task enqueued from now on either is picked up by this
+        // loop or schedules the next drain
+        _drainScheduled.store(false, std::memory_order_release);
+
+        std::function<void()> tasks[kDrainBatchSize];
+        size_t count = 0;
+        while ((count = _queue.try_dequeue_bulk(tasks, kDrainBatchSize)) > 0) {
+            _pending.fetch_sub(count, std::memory_order_relaxed);
+            for (size_t i = 0; i < count; ++i) {
+                tasks[i]();
+                tasks[i] = nullptr;
+            }
+        }
+    }
+
+private:
+    rtc::Thread* _thread;
+
+    moodycamel::ConcurrentQueue<std::function<void()>> _queue;
+
+    std::atomic<bool> _drainScheduled{ false };
+
+    std::atomic<size_t> _pending{ 0 };
+};
+
+}
+
+std::shared_ptr<ThreadDispatchQueue> ThreadDispatchQueue::forThread(rtc::Thread* thread)
+{
+    static std::mutex mutex;
+    static std::unordered_map<rtc::Thread*, std::weak_ptr<ThreadDispatchQueue>> queues;
+
+    if (!thread) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = queues[thread];
+    auto queue = slot.lock();
+    if (!queue) {
+        queue = std::make_shared<ThreadDispatchQueueImpl>(thread);
+        slot = queue;
+    }
+    return queue;
+}
+
+}
@@ -0,0 +1,39 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <functional>
+
+namespace rtc {
+    class Thread;
+}
+
+namespace vi {
+
+    // Multi-producer queue of tasks bound to one rtc::Thread. Tasks posted from any thread are
+    // appended to a lock-free queue and at most one drain task is pending on the target thread,
+    // so a burst of events costs a single wakeup. Order is kept per producing thread.
+    class ThreadDispatchQueue
+    {
+    public:
+        virtual ~ThreadDispatchQueue() = default;
+
+        // Shared queue of the thread, created on first use
+        static std::shared_ptr<ThreadDispatchQueue> forThread(rtc::Thread* thread);
+
+        virtual rtc::Thread* thread() const = 0;
+
+        virtual void post(std::function<void()> task) = 0;
+
+        // Number of tasks not yet run
+        virtual size_t pending() const = 0;
+    };
+}
@@ -9,152 +9,205 @@
 
 #pragma once
 
+#include <cassert>
 #include <type_traits>
-#include <list>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <algorithm>
-#include "absl/types/any.h"
-#include "absl/types/optional.h"
-#include "rtc_base/deprecated/recursive_critical_section.h"
 #include "rtc_base/thread.h"
+#include "thread_dispatch_queue.h"
 
 namespace vi {
+    // How events reach an observer whose thread is not the notifying one
+    enum class ObserverDelivery {
+        // One rtc::Thread::PostTask per event
+        Post,
+        // Appended to the thread's ThreadDispatchQueue, drained by a single task per burst
+        Batched
+    };
+
     template<typename Observer>
     class UniversalObservable {
     public:
         using observer_ptr = std::shared_ptr<Observer>;
-        void addWeakObserver(const observer_ptr &observer, rtc::Thread* thread) {
-            rtc::CritScope scope(&_criticalSection);
-            if (!hasObserverInternal(observer)) {
-                WeakObject wobj(observer, thread);
-                _observers.emplace_back(wobj);
+
+        UniversalObservable() = default;
+
+        UniversalObservable(const UniversalObservable&) = delete;
+
+        UniversalObservable& operator=(const UniversalObservable&) = delete;
+
+        ~UniversalObservable() {
+            delete _observers.load();
+            for (const EntryList* entries : _retired) {
+                delete entries;
             }
         }
+
+        void addWeakObserver(const observer_ptr &observer, rtc::Thread* thread, ObserverDelivery delivery = ObserverDelivery::Post) {
+            addEntry(Entry(observer, thread, true, delivery));
+        }
         
-        void addObserver(const observer_ptr &observer, rtc::Thread* thread) {
-            rtc::CritScope scope(&_criticalSection);
-            if (!hasObserverInternal(observer)) {
-                Object obj(observer, thread);
-                _observers.emplace_back(obj);
-            }
+        void addObserver(const observer_ptr &observer, rtc::Thread* thread, ObserverDelivery delivery = ObserverDelivery::Post) {
+            addEntry(Entry(observer, thread, false, delivery));
         }
         
         void removeObserver(const observer_ptr &observer) {
-            rtc::CritScope scope(&_criticalSection);
-            for (auto it = _observers.begin(); it != _observers.end(); ++it) {
-                auto var = absl::any(*it);
-                if (var.has_value()) {
-                    if (absl::any_cast<WeakObject>(&var)) {
-                        WeakObject wobj = absl::any_cast<WeakObject>(var);
-                        if (wobj.observer.lock() == observer) {
-                            _observers.erase(it);
-                            return;
-                        }
-                    } else if (absl::any_cast<Object>(&var)) {
-                        Object obj = absl::any_cast<Object>(var);
-                        if (obj.observer == observer) {
-                            _observers.erase(it);
-                            return;
-                        }
-                    }
-                }
+            std::lock_guard<std::mutex> locker(_mutex);
+            const EntryList* current = _observers.load();
+            auto it = std::find_if(current->begin(), current->end(), [&observer](const Entry& entry) {
+                return entry.matches(observer);
+            });
+            if (it == current->end()) {
+                return;
             }
+            auto entries = new EntryList(*current);
+            entries->erase(entries->begin() + (it - current->begin()));
+            publish(entries);
         }
         
         void clearObserver() {
-            rtc::CritScope scope(&_criticalSection);
-            _observers.clear();
+            std::lock_guard<std::mutex> locker(_mutex);
+            publish(new EntryList());
         }
         
         size_t numOfObservers() {
-            rtc::CritScope scope(&_criticalSection);
-            return _observers.size();
+            ReadGuard guard(*this);
+            return guard.entries().size();
         }
         
         bool hasObserver(const observer_ptr &observer) {
-            rtc::CritScope scope(&_criticalSection);
-            return hasObserverInternal(observer);
+            ReadGuard guard(*this);
+            return hasObserverInternal(guard.entries(), observer);
         }
         
     protected:
-        bool hasObserverInternal(const observer_ptr &observer) {
-            for (auto it = _observers.begin(); it != _observers.end(); ++it) {
-				auto var = absl::any(*it);
-                if (var.has_value()) {
-                    if (absl::any_cast<WeakObject>(&var)) {
-                        WeakObject wobj = absl::any_cast<WeakObject>(var);
-                        if (wobj.observer.lock() == observer) {
-                            return true;
+        // Walks the published observer list without taking a lock: entering and leaving only
+        // touch the atomic reader count, and nothing is allocated for observers living on the
+        // calling thread. Observers added or removed meanwhile take effect from the next notification.
+        template<typename Notifier>
+        void notifyObservers(Notifier&& notifier) const {
+            ReadGuard guard(*this);
+            for (const auto& entry : guard.entries()) {
+                auto obs = entry.lock();
+                if (!obs) {
+                    continue;
+                }
+                assert(entry.thread);
+                if (entry.thread->IsCurrent()) {
+                    notifier(obs);
+                }
+                else if (entry.queue) {
+                    entry.queue->post([wobs = std::weak_ptr<Observer>(obs), notifier]() {
+                        if (auto observer = wobs.lock()) {
+                            notifier(observer);
                         }
-                    } else if (absl::any_cast<Object>(&var)) {
-                        Object obj = absl::any_cast<Object>(var);
-                        if (obj.observer == observer) {
-                            return true;
+                    });
+                }
+                else {
+                    entry.thread->PostTask([wobs = std::weak_ptr<Observer>(obs), notifier]() {
+                        if (auto observer = wobs.lock()) {
+                            notifier(observer);
                         }
-                    }
+                    });
                 }
             }
-            
-            return false;
         }
         
-    protected:
-        virtual void notifyObservers(std::function<void(const observer_ptr &)> notifier) const {
-            decltype(_observers) observers;
-            {
-                rtc::CritScope scope(&_criticalSection);
-                observers = _observers;
+    private:
+        // Tagged entry, weak observers only keep a weak_ptr so they never extend the observer's lifetime
+        class Entry {
+        public:
+            Entry(const std::shared_ptr<Observer>& o, rtc::Thread* t, bool w, ObserverDelivery d)
+            : strong(w ? nullptr : o)
+            , weak(o)
+            , thread(t)
+            , queue(d == ObserverDelivery::Batched ? ThreadDispatchQueue::forThread(t) : nullptr)
+            , isWeak(w) {
             }
             
-            for (const auto &observer: observers) {
-                auto var = absl::any(observer);
-                if (var.has_value()) {
-                    std::shared_ptr<Observer> obs;
-                    rtc::Thread* thread = nullptr;
-                    
-                    if (absl::any_cast<WeakObject>(&var)) {
-                        WeakObject wobj = absl::any_cast<WeakObject>(var);
-                        obs = wobj.observer.lock();
-                        thread = wobj.thread;
-                    } else if (absl::any_cast<Object>(&var)) {
-                        Object obj = absl::any_cast<Object>(var);
-                        obs = obj.observer;
-                        thread = obj.thread;
-                    }
-                    
-                    if (obs) {
-						assert(thread);
-						if (thread->IsCurrent()) {
-                            notifier(obs);
-						}
-                        else {
-                            thread->PostTask([wobs = std::weak_ptr<Observer>(obs), notifier]() {
-								if (auto observer = wobs.lock()) {
-                                    notifier(observer);
-								}
-							});
-						}
-                    }
-                }
+            std::shared_ptr<Observer> lock() const {
+                return isWeak ? weak.lock() : strong;
             }
-        }
-        
-    private:
-        template<typename T = std::shared_ptr<Observer>>
-        class InnerObject {
-        public:
-            InnerObject(std::shared_ptr<Observer> o, rtc::Thread* t)
-            : observer(o)
-            , thread(t) {
+            
+            bool matches(const std::shared_ptr<Observer>& o) const {
+                return isWeak ? weak.lock() == o : strong == o;
             }
             
-            T observer;
+            std::shared_ptr<Observer> strong;
+            std::weak_ptr<Observer> weak;
             rtc::Thread* thread;
+            std::shared_ptr<ThreadDispatchQueue> queue;
+            bool isWeak;
+        };
+        
+        using EntryList = std::vector<Entry>;
+
+        // Pins the published list for as long as it lives. The count goes up before the pointer is
+        // loaded, so a writer that still sees zero readers after swapping the pointer knows nobody
+        // can be holding the lists it retired.
+        class ReadGuard {
+        public:
+            explicit ReadGuard(const UniversalObservable& observable)
+            : _observable(observable) {
+                _observable._readers.fetch_add(1);
+                _entries = _observable._observers.load();
+            }
+
+            ~ReadGuard() {
+                _observable._readers.fetch_sub(1);
+            }
+
+            const EntryList& entries() const {
+                return *_entries;
+            }
+
+        private:
+            const UniversalObservable& _observable;
+            const EntryList* _entries;
         };
         
-        using WeakObject = InnerObject<std::weak_ptr<Observer>>;
-        using Object = InnerObject<std::shared_ptr<Observer>>;
+        static bool hasObserverInternal(const EntryList& entries, const observer_ptr &observer) {
+            return std::any_of(entries.begin(), entries.end(), [&observer](const Entry& entry) {
+                return entry.matches(observer);
+            });
+        }
+        
+        void addEntry(Entry&& entry) {
+            std::lock_guard<std::mutex> locker(_mutex);
+            const EntryList* current = _observers.load();
+            if (hasObserverInternal(*current, entry.lock())) {
+                return;
+            }
+            auto entries = new EntryList();
+            entries->reserve(current->size() + 1);
+            entries->assign(current->begin(), current->end());
+            entries->emplace_back(std::move(entry));
+            publish(entries);
+        }
         
-        rtc::RecursiveCriticalSection _criticalSection;
-        std::list<absl::any> _observers;
+        // Called with _mutex held. Lists replaced while a notification is running, e.g. by an
+        // observer removing itself from its callback, are freed by a later write or the destructor.
+        void publish(const EntryList* entries) {
+            _retired.push_back(_observers.exchange(entries));
+            if (_readers.load() != 0) {
+                return;
+            }
+            for (const EntryList* retired : _retired) {
+                delete retired;
+            }
+            _retired.clear();
+        }
+        
+    private:
+        // Serializes writers only, readers go through ReadGuard
+        std::mutex _mutex;
+        // Sequentially consistent like _readers, the reclamation in publish() relies on both
+        std::atomic<const EntryList*> _observers { new EntryList() };
+        mutable std::atomic<uint32_t> _readers { 0 };
+        // Replaced lists that a reader may still be walking, guarded by _mutex
+        std::vector<const EntryList*> _retired;
     };
 }
@@ -119,12 +119,13 @@ namespace vi {
 	template<typename T, typename MsgPtr>
 	void ConnectionMetadata<T, MsgPtr>::onMessage(T* c, websocketpp::connection_hdl, MsgPtr msg) {
 		if (auto observer = _observer.lock()) {
-			if (msg->get_opcode() == websocketpp::frame::opcode::text) {
-				observer->onTextMessage(msg->get_payload());
+			// Keep the message alive instead of copying its payload
+			auto opcode = msg->get_opcode();
+			if (opcode == websocketpp::frame::opcode::text) {
+				observer->onTextMessage(InboundMessage::wrap(msg));
 			}
-			else if (msg->get_opcode() == websocketpp::frame::opcode::binary) {
-				std::vector<uint8_t> data(msg->get_payload().begin(), msg->get_payload().end());
-				observer->onBinaryMessage(data);
+			else if (opcode == websocketpp::frame::opcode::binary) {
+				observer->onBinaryMessage(InboundMessage::wrap(msg));
 			}
 		}
 	}
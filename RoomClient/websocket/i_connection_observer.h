@@ -9,8 +9,10 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
+#include "inbound_message.h"
 
 namespace vi {
     class IConnectionObserver {
@@ -25,9 +27,9 @@ namespace vi {
 
 		virtual bool onValidate() = 0;
 
-		virtual void onTextMessage(const std::string& text) = 0;
+		virtual void onTextMessage(std::shared_ptr<InboundMessage> message) = 0;
 
-		virtual void onBinaryMessage(const std::vector<uint8_t>& data) = 0;
+		virtual void onBinaryMessage(std::shared_ptr<InboundMessage> message) = 0;
 
 		virtual bool onPing(const std::string& text) = 0;
 
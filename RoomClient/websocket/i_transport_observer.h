@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <string>
+#include "inbound_message.h"
 
 namespace vi {
     class ITransportObserver
@@ -24,7 +25,7 @@ namespace vi {
 
 		virtual void onFailed(int errorCode, const std::string& reason) = 0;
 
-		virtual void onMessage(const std::string& json) = 0;
+		virtual void onMessage(std::shared_ptr<InboundMessage> message) = 0;
 
 	};
 }
@@ -0,0 +1,57 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "absl/strings/string_view.h"
+
+namespace vi {
+
+// Read-only view on the payload of an inbound websocket frame. The owning
+// websocketpp message is kept alive for as long as any holder of the view,
+// so the payload crosses threads without being copied.
+class InboundMessage {
+public:
+    template<typename MsgPtr>
+    static std::shared_ptr<InboundMessage> wrap(MsgPtr msg) {
+        auto owner = std::make_shared<MsgPtr>(std::move(msg));
+        const std::string& payload = (*owner)->get_payload();
+        return std::shared_ptr<InboundMessage>(new InboundMessage(owner, absl::string_view(payload.data(), payload.size())));
+    }
+
+    absl::string_view payload() const {
+        return _payload;
+    }
+
+    const char* data() const {
+        return _payload.data();
+    }
+
+    size_t size() const {
+        return _payload.size();
+    }
+
+    bool empty() const {
+        return _payload.empty();
+    }
+
+private:
+    InboundMessage(std::shared_ptr<const void> owner, absl::string_view payload)
+        : _owner(std::move(owner))
+        , _payload(payload) {}
+
+private:
+    std::shared_ptr<const void> _owner;
+
+    absl::string_view _payload;
+};
+
+}
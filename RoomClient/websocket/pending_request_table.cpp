@@ -0,0 +1,176 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "pending_request_table.h"
+#include "websocket_request.h"
+
+namespace vi {
+
+namespace {
+    size_t roundUpPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+PendingRequestTable::PendingRequestTable(size_t shardCount, size_t shardCapacity)
+{
+    shardCount = roundUpPowerOfTwo(shardCount);
+    shardCapacity = roundUpPowerOfTwo(shardCapacity < 2 ? 2 : shardCapacity);
+    _shardMask = shardCount - 1;
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->slots.resize(shardCapacity);
+        _shards.emplace_back(std::move(shard));
+    }
+}
+
+PendingRequestTable::~PendingRequestTable()
+{
+    clear();
+}
+
+uint64_t PendingRequestTable::hash(int64_t id)
+{
+    // splitmix64 finalizer, protoo ids are not uniformly distributed in the low bits
+    uint64_t x = static_cast<uint64_t>(id);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+PendingRequestTable::Shard& PendingRequestTable::shardOf(uint64_t h)
+{
+    return *_shards[h & _shardMask];
+}
+
+size_t PendingRequestTable::homeOf(const Shard& shard, uint64_t h)
+{
+    return (h >> 32) & (shard.slots.size() - 1);
+}
+
+void PendingRequestTable::grow(Shard& shard)
+{
+    std::vector<Slot> old(shard.slots.size() * 2);
+    old.swap(shard.slots);
+    const size_t mask = shard.slots.size() - 1;
+    for (auto& slot : old) {
+        if (!slot.used) {
+            continue;
+        }
+        size_t i = homeOf(shard, hash(slot.id));
+        while (shard.slots[i].used) {
+            i = (i + 1) & mask;
+        }
+        shard.slots[i] = std::move(slot);
+    }
+}
+
+void PendingRequestTable::insert(int64_t id, std::shared_ptr<WebsocketRequest> request)
+{
+    const uint64_t h = hash(id);
+    auto& shard = shardOf(h);
+    std::lock_guard<std::mutex> locker(shard.mutex);
+
+    // Keep the load factor below 1/2 so probe sequences stay short
+    if ((shard.count + 1) * 2 > shard.slots.size()) {
+        grow(shard);
+    }
+
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = homeOf(shard, h);
+    while (shard.slots[i].used) {
+        if (shard.slots[i].id == id) {
+            shard.slots[i].request = std::move(request);
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    shard.slots[i].id = id;
+    shard.slots[i].used = true;
+    shard.slots[i].request = std::move(request);
+    ++shard.count;
+    _size.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::shared_ptr<WebsocketRequest> PendingRequestTable::take(int64_t id)
+{
+    const uint64_t h = hash(id);
+    auto& shard = shardOf(h);
+    std::lock_guard<std::mutex> locker(shard.mutex);
+
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = homeOf(shard, h);
+    while (shard.slots[i].used && shard.slots[i].id != id) {
+        i = (i + 1) & mask;
+    }
+    if (!shard.slots[i].used) {
+        return nullptr;
+    }
+
+    auto request = std::move(shard.slots[i].request);
+
+    // Backward-shift deletion, no tombstones
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (!shard.slots[j].used) {
+            break;
+        }
+        size_t k = homeOf(shard, hash(shard.slots[j].id));
+        bool movable = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+        if (movable) {
+            shard.slots[i] = std::move(shard.slots[j]);
+            i = j;
+        }
+    }
+    shard.slots[i] = Slot();
+
+    --shard.count;
+    _size.fetch_sub(1, std::memory_order_relaxed);
+
+    return request;
+}
+
+std::vector<std::shared_ptr<WebsocketRequest>> PendingRequestTable::takeAll()
+{
+    std::vector<std::shared_ptr<WebsocketRequest>> requests;
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> locker(shard->mutex);
+        for (auto& slot : shard->slots) {
+            if (slot.used) {
+                requests.emplace_back(std::move(slot.request));
+                slot = Slot();
+            }
+        }
+        _size.fetch_sub(shard->count, std::memory_order_relaxed);
+        shard->count = 0;
+    }
+    return requests;
+}
+
+void PendingRequestTable::clear()
+{
+    takeAll();
+}
+
+size_t PendingRequestTable::size() const
+{
+    return _size.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,71 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+namespace vi {
+
+class WebsocketRequest;
+
+// Concurrent open-addressing table of in-flight protoo transactions.
+// Keys are hashed onto independently locked shards, each shard is a linear
+// probing array with backward-shift deletion, the size is kept atomically.
+class PendingRequestTable {
+public:
+    explicit PendingRequestTable(size_t shardCount = 16, size_t shardCapacity = 16);
+
+    ~PendingRequestTable();
+
+    // Replaces an existing entry with the same id
+    void insert(int64_t id, std::shared_ptr<WebsocketRequest> request);
+
+    // Removes and returns the entry, nullptr if absent
+    std::shared_ptr<WebsocketRequest> take(int64_t id);
+
+    std::vector<std::shared_ptr<WebsocketRequest>> takeAll();
+
+    void clear();
+
+    size_t size() const;
+
+private:
+    struct Slot {
+        int64_t id = 0;
+        bool used = false;
+        std::shared_ptr<WebsocketRequest> request;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots;
+        size_t count = 0;
+    };
+
+    static uint64_t hash(int64_t id);
+
+    Shard& shardOf(uint64_t h);
+
+    static size_t homeOf(const Shard& shard, uint64_t h);
+
+    static void grow(Shard& shard);
+
+private:
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    size_t _shardMask;
+
+    std::atomic<size_t> _size{ 0 };
+};
+
+}
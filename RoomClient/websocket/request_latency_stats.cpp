@@ -0,0 +1,87 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "request_latency_stats.h"
+
+namespace vi {
+
+void LatencyHistogram::record(uint64_t ms)
+{
+    size_t index = 0;
+    while (index < kRequestLatencyBucketsMs.size() && ms > kRequestLatencyBucketsMs[index]) {
+        ++index;
+    }
+    _buckets[index].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sumMs.fetch_add(ms, std::memory_order_relaxed);
+
+    uint64_t max = _maxMs.load(std::memory_order_relaxed);
+    while (ms > max && !_maxMs.compare_exchange_weak(max, ms, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::recordTimeout()
+{
+    _timeouts.fetch_add(1, std::memory_order_relaxed);
+}
+
+RequestLatencySnapshot LatencyHistogram::snapshot() const
+{
+    RequestLatencySnapshot snapshot;
+    snapshot.count = _count.load(std::memory_order_relaxed);
+    snapshot.timeouts = _timeouts.load(std::memory_order_relaxed);
+    snapshot.sumMs = _sumMs.load(std::memory_order_relaxed);
+    snapshot.maxMs = _maxMs.load(std::memory_order_relaxed);
+    snapshot.buckets.reserve(_buckets.size());
+    for (const auto& bucket : _buckets) {
+        snapshot.buckets.emplace_back(bucket.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+std::shared_ptr<LatencyHistogram> RequestLatencyStats::histogram(const std::string& method)
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    auto& histogram = _histograms[method];
+    if (!histogram) {
+        histogram = std::make_shared<LatencyHistogram>();
+    }
+    return histogram;
+}
+
+void RequestLatencyStats::record(const std::string& method, uint64_t ms)
+{
+    histogram(method)->record(ms);
+}
+
+void RequestLatencyStats::recordTimeout(const std::string& method)
+{
+    histogram(method)->recordTimeout();
+}
+
+std::vector<RequestLatencySnapshot> RequestLatencyStats::snapshot()
+{
+    std::vector<RequestLatencySnapshot> snapshots;
+    std::lock_guard<std::mutex> locker(_mutex);
+    snapshots.reserve(_histograms.size());
+    for (const auto& it : _histograms) {
+        auto snapshot = it.second->snapshot();
+        snapshot.method = it.first;
+        snapshots.emplace_back(std::move(snapshot));
+    }
+    return snapshots;
+}
+
+void RequestLatencyStats::reset()
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    _histograms.clear();
+}
+
+}
@@ -0,0 +1,71 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace vi {
+
+// Upper bounds (ms) of the latency buckets, the last bucket is unbounded
+static constexpr std::array<uint32_t, 11> kRequestLatencyBucketsMs = { 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000 };
+
+struct RequestLatencySnapshot {
+    std::string method;
+    uint64_t count = 0;
+    uint64_t timeouts = 0;
+    uint64_t sumMs = 0;
+    uint64_t maxMs = 0;
+    // kRequestLatencyBucketsMs.size() + 1 counters
+    std::vector<uint64_t> buckets;
+};
+
+class LatencyHistogram {
+public:
+    void record(uint64_t ms);
+
+    void recordTimeout();
+
+    RequestLatencySnapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kRequestLatencyBucketsMs.size() + 1> _buckets{};
+    std::atomic<uint64_t> _count{ 0 };
+    std::atomic<uint64_t> _timeouts{ 0 };
+    std::atomic<uint64_t> _sumMs{ 0 };
+    std::atomic<uint64_t> _maxMs{ 0 };
+};
+
+// Per-method round trip latency of signaling requests
+class RequestLatencyStats {
+public:
+    void record(const std::string& method, uint64_t ms);
+
+    void recordTimeout(const std::string& method);
+
+    std::vector<RequestLatencySnapshot> snapshot();
+
+    void reset();
+
+private:
+    std::shared_ptr<LatencyHistogram> histogram(const std::string& method);
+
+private:
+    std::mutex _mutex;
+
+    std::unordered_map<std::string, std::shared_ptr<LatencyHistogram>> _histograms;
+};
+
+}
@@ -0,0 +1,134 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#include "request_timer_wheel.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+
+namespace vi {
+
+RequestTimerWheel::RequestTimerWheel(rtc::Thread* thread, uint32_t tickInterval, size_t slotCount)
+    : _thread(thread)
+    , _tickInterval(tickInterval > 0 ? tickInterval : 1)
+    , _slots(slotCount > 0 ? slotCount : 1)
+{
+
+}
+
+RequestTimerWheel::~RequestTimerWheel()
+{
+    cancelAll();
+}
+
+void RequestTimerWheel::setTimeoutHandler(TimeoutHandler handler)
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    _handler = handler;
+}
+
+void RequestTimerWheel::arm(int64_t id, uint32_t timeout)
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+
+    auto it = _timers.find(id);
+    if (it != _timers.end()) {
+        _slots[it->second.slot].erase(it->second.it);
+        _timers.erase(it);
+    }
+
+    uint64_t ticks = (timeout + _tickInterval - 1) / _tickInterval;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    size_t slot = (_cursor + ticks) % _slots.size();
+    uint64_t rounds = (ticks - 1) / _slots.size();
+
+    auto& timers = _slots[slot];
+    timers.push_back({ id, rounds });
+    _timers[id] = { slot, std::prev(timers.end()) };
+
+    scheduleTick();
+}
+
+void RequestTimerWheel::cancel(int64_t id)
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    auto it = _timers.find(id);
+    if (it != _timers.end()) {
+        _slots[it->second.slot].erase(it->second.it);
+        _timers.erase(it);
+    }
+}
+
+void RequestTimerWheel::cancelAll()
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    for (auto& slot : _slots) {
+        slot.clear();
+    }
+    _timers.clear();
+}
+
+size_t RequestTimerWheel::size()
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    return _timers.size();
+}
+
+void RequestTimerWheel::scheduleTick()
+{
+    // Called with _mutex held
+    if (_ticking || !_thread) {
+        return;
+    }
+    _ticking = true;
+    _thread->PostDelayedTask(webrtc::ToQueuedTask([wself = weak_from_this()]() {
+        if (auto self = wself.lock()) {
+            self->tick();
+        }
+    }), _tickInterval);
+}
+
+void RequestTimerWheel::tick()
+{
+    std::vector<int64_t> expired;
+    TimeoutHandler handler;
+    {
+        std::lock_guard<std::mutex> locker(_mutex);
+        _ticking = false;
+        _cursor = (_cursor + 1) % _slots.size();
+
+        auto& timers = _slots[_cursor];
+        for (auto it = timers.begin(); it != timers.end();) {
+            if (it->rounds == 0) {
+                expired.emplace_back(it->id);
+                _timers.erase(it->id);
+                it = timers.erase(it);
+            }
+            else {
+                --it->rounds;
+                ++it;
+            }
+        }
+
+        if (!_timers.empty()) {
+            scheduleTick();
+        }
+        handler = _handler;
+    }
+
+    if (handler) {
+        for (auto id : expired) {
+            handler(id);
+        }
+    }
+}
+
+}
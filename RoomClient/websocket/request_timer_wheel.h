@@ -0,0 +1,82 @@
+/************************************************************************
+* @Copyright: 2021-2024
+* @FileName:
+* @Description: Open source mediasoup room client library
+* @Version: 1.0.0
+* @Author: Jackie Ou
+* @CreateTime: 2021-10-1
+*************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
+
+namespace rtc {
+    class Thread;
+}
+
+namespace vi {
+
+// Hashed timer wheel tracking the timeouts of all in-flight requests.
+// Ticks run on the given thread and only while at least one timer is armed,
+// arm/cancel are O(1) and can be called from any thread.
+class RequestTimerWheel : public std::enable_shared_from_this<RequestTimerWheel> {
+public:
+    using TimeoutHandler = std::function<void(int64_t id)>;
+
+    RequestTimerWheel(rtc::Thread* thread, uint32_t tickInterval = 100, size_t slotCount = 256);
+
+    ~RequestTimerWheel();
+
+    // Invoked on the wheel thread for every expired timer
+    void setTimeoutHandler(TimeoutHandler handler);
+
+    void arm(int64_t id, uint32_t timeout);
+
+    void cancel(int64_t id);
+
+    void cancelAll();
+
+    size_t size();
+
+private:
+    void scheduleTick();
+
+    void tick();
+
+private:
+    struct Timer {
+        int64_t id;
+        uint64_t rounds;
+    };
+
+    using Slot = std::list<Timer>;
+
+    struct Location {
+        size_t slot;
+        Slot::iterator it;
+    };
+
+    rtc::Thread* _thread;
+
+    const uint32_t _tickInterval;
+
+    std::mutex _mutex;
+
+    std::vector<Slot> _slots;
+
+    std::unordered_map<int64_t, Location> _timers;
+
+    size_t _cursor = 0;
+
+    bool _ticking = false;
+
+    TimeoutHandler _handler;
+};
+
+}
@@ -12,13 +12,14 @@
 #include <memory>
 #include <vector>
 #include <functional>
+#include <chrono>
 #include "logger/spd_logger.h"
 #include "i_transport.h"
-#include "asio.hpp"
+#include "absl/strings/string_view.h"
 
 namespace vi {
 
-using ResolveCallback = std::function<void(const std::string& json)>;
+using ResolveCallback = std::function<void(absl::string_view json)>;
 using RejectCallback = std::function<void(int32_t errorCode, const std::string& errorInfo)>;
 
 class WebsocketRequest {
@@ -26,22 +27,34 @@ public:
     WebsocketRequest(int64_t id, uint32_t timeout)
         : _id(id)
         , _timeout(timeout)
-        , _timer(_context) {
+        , _createTime(std::chrono::steady_clock::now()) {
         DLOG("request.id = {}", _id);
     }
 
-    ~WebsocketRequest() {
-        _timer.cancel();
-        //_context.stop();
-        if (_thread.joinable()) {
-            _thread.join();
-        }
-    }
+    ~WebsocketRequest() = default;
 
-    int32_t id() {
+    int64_t id() {
         return _id;
     }
 
+    // Armed on the RequestTimerWheel owned by the signaling client
+    uint32_t timeoutMs() {
+        return _timeout;
+    }
+
+    void setMethod(const std::string& method) {
+        _method = method;
+    }
+
+    const std::string& method() {
+        return _method;
+    }
+
+    // Milliseconds since the request was created
+    uint64_t elapsedMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _createTime).count();
+    }
+
     void setText(const std::string& text) {
         _text = text;
     }
@@ -58,19 +71,6 @@ public:
         return _data;
     }
 
-    const asio::steady_timer& timer() {
-        return _timer;
-    }
-
-    void ticktock() {
-        _timer.expires_after(std::chrono::milliseconds(_timeout));
-        _timer.async_wait(std::bind(&WebsocketRequest::timeout, this));
-        _thread = std::thread([this](){
-            _context.run();
-            DLOG("--> stoped");
-        });
-    }
-
     void setResolveCallback(ResolveCallback resolve) {
         _resolve = resolve;
     }
@@ -79,29 +79,25 @@ public:
         _reject = reject;
     }
 
-    void resolve(const std::string& json) {
-        _timer.cancel();
+    void resolve(absl::string_view json) {
         if (_resolve) {
             _resolve(json);
         }
     }
 
     void reject(int32_t errorCode, const std::string& errorInfo) {
-        _timer.cancel();
         if (_reject) {
             _reject(errorCode, errorInfo);
         }
     }
 
     void timeout() {
-        _timer.cancel();
         if (_reject) {
-            //_reject(1, "request timeout");
+            _reject(1, "request timeout");
         }
     }
 
     void close() {
-        _timer.cancel();
         if (_reject) {
             _reject(2, "connection closed");
         }
@@ -109,14 +105,13 @@ public:
 
 private:
     int64_t _id = -1;
+    std::string _method;
     std::string _text;
     std::vector<uint8_t> _data;
     ResolveCallback _resolve;
     RejectCallback _reject;
     uint32_t _timeout;
-    asio::io_context _context;
-    asio::steady_timer _timer;
-    std::thread _thread;
+    std::chrono::steady_clock::time_point _createTime;
 };
 
 }
@@ -62,9 +62,9 @@ namespace vi {
 
 		bool onValidate() override;
 
-		void onTextMessage(const std::string& text) override;
+		void onTextMessage(std::shared_ptr<InboundMessage> message) override;
 
-		void onBinaryMessage(const std::vector<uint8_t>& data) override;
+		void onBinaryMessage(std::shared_ptr<InboundMessage> message) override;
 
 		bool onPing(const std::string& text) override;
 
@@ -216,20 +216,23 @@ namespace vi {
     }
 
     template<typename T>
-    void WebsocketTransport<T>::onTextMessage(const std::string& json)
+    void WebsocketTransport<T>::onTextMessage(std::shared_ptr<InboundMessage> message)
     {
-        DLOG("json = {}", json.c_str());
-        UniversalObservable<ITransportObserver>::notifyObservers([wself = WebsocketTransport<T>::weak_from_this(), msg = json](const auto& observer) {
+        if (!message) {
+            return;
+        }
+        DLOG("text message, size = {}", message->size());
+        UniversalObservable<ITransportObserver>::notifyObservers([wself = WebsocketTransport<T>::weak_from_this(), message](const auto& observer) {
             if (auto self = wself.lock()) {
-                observer->onMessage(msg);
+                observer->onMessage(message);
             }
         });
     }
 
     template<typename T>
-    void WebsocketTransport<T>::onBinaryMessage(const std::vector<uint8_t>& data)
+    void WebsocketTransport<T>::onBinaryMessage(std::shared_ptr<InboundMessage> message)
     {
-        DLOG("data.size() = {}", data.size());
+        DLOG("binary message, size = {}", message ? message->size() : 0);
     }
 
     template<typename T>